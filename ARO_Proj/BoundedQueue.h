@@ -0,0 +1,100 @@
+////////////////////
+// BoundedQueue.h - fixed capacity lock-free queue for one producer thread and one consumer thread
+////////////////////
+
+#ifndef BOUNDED_QUEUE_H_
+#define BOUNDED_QUEUE_H_
+
+#include <atomic>	// head_ & tail_
+#include <thread>	// std::this_thread::yield() while waiting
+
+// Single producer single consumer ring buffer, used to hand work between the stages of the evaluation pipeline
+// push()/tryPush() must only be called from one thread and pop()/tryPop() from one (other) thread.
+// The blocking versions spin briefly then yield, the stages they connect each run a tight loop on a dedicated thread.
+// T - element type, copied in and out (keep small, such as an index)
+template <class T>
+class BoundedQueue {
+private:
+	// Storage of capacity + 1 elements (one is always empty to tell full from empty)
+	T * buffer_;
+	int size_;
+	// Index of the next element to pop, only written by the consumer
+	std::atomic<int> head_;
+	// Padding so the producer and consumer indices are not on the same cache line
+	char pad_[64];
+	// Index of the next element to push, only written by the producer
+	std::atomic<int> tail_;
+
+	int advance(int i) const {
+		return (i + 1 == this->size_) ? 0 : i + 1;
+	}
+
+public:
+	// Constructor
+	// Input: capacity - number of elements the queue can hold
+	BoundedQueue(int capacity) {
+		this->size_ = capacity + 1;
+		this->buffer_ = new T[this->size_];
+		this->head_.store(0, std::memory_order_relaxed);
+		this->tail_.store(0, std::memory_order_relaxed);
+	}
+
+	~BoundedQueue() {
+		delete[] this->buffer_;
+	}
+
+	BoundedQueue(const BoundedQueue & other) = delete;
+	BoundedQueue& operator=(const BoundedQueue & other) = delete;
+
+	// Add an element if there is room (producer only)
+	// Output: false if the queue is full
+	bool tryPush(const T & value) {
+		const int tail = this->tail_.load(std::memory_order_relaxed);
+		const int next = this->advance(tail);
+		if (next == this->head_.load(std::memory_order_acquire)) {
+			return false;
+		}
+		this->buffer_[tail] = value;
+		this->tail_.store(next, std::memory_order_release);
+		return true;
+	}
+
+	// Remove the oldest element if there is one (consumer only)
+	// Output: false if the queue is empty, otherwise value is set
+	bool tryPop(T & value) {
+		const int head = this->head_.load(std::memory_order_relaxed);
+		if (head == this->tail_.load(std::memory_order_acquire)) {
+			return false;
+		}
+		value = this->buffer_[head];
+		this->head_.store(this->advance(head), std::memory_order_release);
+		return true;
+	}
+
+	// Add an element, waiting for room (producer only)
+	void push(const T & value) {
+		for (int spins = 0; !this->tryPush(value); spins++) {
+			if (spins > 64) {
+				std::this_thread::yield();
+			}
+		}
+	}
+
+	// Remove the oldest element, waiting for one (consumer only)
+	T pop() {
+		T value;
+		for (int spins = 0; !this->tryPop(value); spins++) {
+			if (spins > 64) {
+				std::this_thread::yield();
+			}
+		}
+		return value;
+	}
+
+	// Number of elements the queue can hold
+	const int getCapacity() const {
+		return this->size_ - 1;
+	}
+};
+
+#endif
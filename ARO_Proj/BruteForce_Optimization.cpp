@@ -53,6 +53,7 @@ bool BruteForce_Optimization::runIndividual(int boardID) {
 	setBlankSlmImg(slmImg);
 
 	bool endOpt = false;
+	int previousBinIndex = -1; // Bin tuned before the current one (set to its best value since the last write)
 	try {
 		// Iterate through columns
 		for (int binCol = 0; binCol < this->cc->numberOfBinsX && !endOpt; binCol++) {
@@ -75,8 +76,9 @@ bool BruteForce_Optimization::runIndividual(int boardID) {
 					// Assign at current bin the new value to test
 					slmImg[binIndex] = curBinVal;
 
-					// Scale and Write to board
-					this->scalers[boardID]->TranslateImage(slmImg, this->slmScaledImages[boardID]);
+					// Scale and Write to board, only the bins changed since the last write are rendered again
+					int dirtyBins[2] = { binIndex, previousBinIndex };
+					this->scalers[boardID]->UpdateBins(slmImg, this->slmScaledImages[boardID], dirtyBins, 2);
 
 					this->usingHardware = true;
 
@@ -100,14 +102,18 @@ bool BruteForce_Optimization::runIndividual(int boardID) {
 					}
 					// Determine fitness
 
-					double exposureTimesRatio = this->cc->GetExposureRatio();
-					double fitness = Utility::FindAverageValue(camImg, curImage->getWidth(), curImage->getHeight(), this->cc->targetRadius);
+					// Intensities are recorded relative to the initial exposure (that of the frame), ratios as they are
+					const double frameExposureRatio = this->cc->GetExposureRatio(curImage->getExposureTime());
+					double exposureTimesRatio = this->fitnessFunction.fitnessScale(frameExposureRatio);
+					double targetMean;
+					std::vector<double> spotMeans(this->fitnessFunction.getSpotCount());
+					double fitness = this->fitnessFunction.evaluate(curImage->getPixelData(), curImage->getPixelEncoding(), curImage->getWidth(), curImage->getHeight(), targetMean, spotMeans.data());
 
 					//Record current performance to file //Ask what kind of calcualtion is this?
 					double ms = boardID*this->phaseResolution + curBinVal / this->phaseResolution;
 					if (this->logAllFiles || this->saveTimeVSFitness) {
-						this->timeVsFitnessFile << this->timestamp->MS_SinceStart() << " " << fitness * this->cc->GetExposureRatio() << " " << this->cc->GetExposureRatio() << std::endl;
-						this->tfile << ms << " " << fitness * this->cc->GetExposureRatio() << " " << this->cc->GetExposureRatio() << std::endl;
+						this->timeVsFitnessFile << this->timestamp->MS_SinceStart() << " " << fitness * exposureTimesRatio << " " << frameExposureRatio << spotColumns(spotMeans, exposureTimesRatio, ' ') << std::endl;
+						this->tfile << ms << " " << fitness * exposureTimesRatio << " " << frameExposureRatio << std::endl;
 					}
 					// Keep record of the best fitness value and image
 					if (fitness * exposureTimesRatio > fitValMax) {
@@ -118,10 +124,9 @@ bool BruteForce_Optimization::runIndividual(int boardID) {
 						this->bestImage = curImage;
 
 					}
-					// Halve the exposure time if over max fitness allowed
-					if (fitness > this->maxFitnessValue) {
-						this->cc->HalfExposureTime();
-					}
+					// Shorten the exposure for the next bin values if the frames are getting close to saturating
+					controlExposure(curImage, targetMean);
+					applyPendingExposure();
 					// Deallocate current image if not the best one
 					if (curImage != this->bestImage) {
 						delete curImage;
@@ -136,6 +141,7 @@ bool BruteForce_Optimization::runIndividual(int boardID) {
 				}
 
 				slmImg[binIndex] = binValMax;
+				previousBinIndex = binIndex;
 
 				// Save progress data
 				if (this->logAllFiles) {
@@ -173,6 +179,15 @@ bool BruteForce_Optimization::setupInstanceVariables() {
 		this->slmDisplayVector[0]->OpenDisplay(240, 240);
 	}
 
+	// Brute force steps through the rectangular bins, so other SLM segmentations are not used
+	if (!this->indexMaps.empty()) {
+		Utility::printLine("WARNING: " + this->algorithm_name_ + " only supports rectangular bins over the whole SLM, ignoring the SLM segmentation!");
+		this->indexMaps.clear();
+	}
+	if (this->basisType != BasisType::Bins) {
+		Utility::printLine("WARNING: " + this->algorithm_name_ + " steps through bin values, ignoring the " + ModalBasis::typeName(this->basisType) + " basis!");
+		this->basisType = BasisType::Bins;
+	}
 	// Scaler Setup (using base class)
 	this->slmScaledImages.clear();
 	// Setup the scaled images vector
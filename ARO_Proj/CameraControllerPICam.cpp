@@ -83,7 +83,23 @@ bool CameraController::startCamera() {
 		return false;
 	}
 
+	// Cache the readout geometry for AcquireImage() and size the frame pool to match (frames are kept at 2-byte depth)
+	this->readoutStride_ = readout_size;
+	Picam_GetParameterIntegerValue(this->camera_, PicamParameter_FrameSize, &this->frameSize_);
+	const size_t frameBytes = size_t(this->frameSize_);
+	if (!this->framePool_ || this->framePool_->getBufferSize() != frameBytes) {
+		this->framePool_ = std::make_shared<FrameBufferPool>(frameBytes);
+	}
+
+	// Exposure changes during the run are made online if the camera allows it
+	pibln onlineable = false;
+	Picam_CanSetParameterOnline(this->camera_, PicamParameter_ExposureTime, &onlineable);
+	this->exposureOnline_ = (onlineable != 0);
+	this->previousExposureTime_ = this->finalExposureTime;
+	this->exposureChangedAt_ = 0;
+
 	// Starting acquisition now that buffer has been setup!
+	this->frameCounter_ = 0;
 	err = Picam_StartAcquisition(this->camera_);
 	if (err != PicamError_None) {
 		Utility::printLine("ERROR: Failed to start acquisition!");
@@ -97,18 +113,23 @@ bool CameraController::startCamera() {
 
 // Get most recent image
 ImageController* CameraController::AcquireImage() {
+	FrameStamp stamp;
+	return AcquireImage(stamp);
+}
+
+// Get most recent image along with its timing
+// Input: stamp - set to the frame id (count of readouts since starting) and exposure of the image,
+//				  the exposure start is conservatively estimated from arrival in the host SteadyClock timebase
+// Output: the image, NULL if an error occurred
+ImageController* CameraController::AcquireImage(FrameStamp & stamp) {
 	// Get most recent image and return within ImageController class
 	PicamAvailableData curImageData;
 	PicamAcquisitionStatus curr_status;
 	PicamError result;
 
-	// Get the frame (size of image data itself in bytes) and readout (image and meta data)
-	piint frame_size = 0;
-	Picam_GetParameterIntegerValue(this->camera_, PicamParameter_FrameSize, &frame_size);
-	piint readout_size = 0;
-	Picam_GetParameterIntegerValue(this->camera_, PicamParameter_ReadoutStride, &readout_size);
-
-	int num_pixels = int(frame_size) / 2; // Number of pixels is half the size in bytes (2-byte depth for each pixel)
+	// The frame (size of image data itself in bytes) and readout (image and meta data) as cached by startCamera()
+	const piint readout_size = this->readoutStride_;
+	int num_pixels = int(this->frameSize_) / 2; // Number of pixels is half the size in bytes (2-byte depth for each pixel)
 
 	// Grab an image
 	// Attempt for acquisiton that is using (hopefully faster) asynchronous approach
@@ -123,15 +144,29 @@ ImageController* CameraController::AcquireImage() {
 		Utility::printLine("ERROR: Failed to acquire data from camera!");
 		return NULL;
 	}
+	// Exposure started no later than a frame period plus the exposure before arrival
+	// The frame was taken with the exposure in effect a frame period before arrival (readouts carry no exposure)
+	const long long received = SteadyClock().now();
+	double frameExposure;
+	{
+		std::unique_lock<std::mutex> lock(this->exposureMutex_);
+		frameExposure = (received - (long long)(1e9 / this->fps) >= this->exposureChangedAt_) ? this->finalExposureTime : this->previousExposureTime_;
+	}
+	this->frameCounter_ += curImageData.readout_count;
+	stamp.frame_id = this->frameCounter_ - 1;
+	stamp.exposure = (long long)(frameExposure * 1000);
+	stamp.exposure_start = received - stamp.exposure - (long long)(1e9 / this->fps);
 
 	// Getting a pointer to the most recent frame (our most recent image data) by skipping older readouts (simple method should have readout_count == 1)
 		// Cast to char to offset by bytes
 	unsigned char* curr_frame = (unsigned char*)curImageData.initial_readout;
 	curr_frame = curr_frame + readout_size*(curImageData.readout_count - 1);
 
-	// Copy data into ImageController, but be sure to convert from 2 byte elements to 1 byte
+	// Copy data into a pooled buffer of the ImageController, keeping the 2 byte elements (converted to 1 byte only for display and saving)
 		// Casting the frame pointer as type unsigned short (2 byte elements)
-	return new ImageController((unsigned short *)curr_frame, num_pixels, this->cameraImageWidth, this->cameraImageHeight);
+	ImageController * image = new ImageController((unsigned short *)curr_frame, num_pixels, this->cameraImageWidth, this->cameraImageHeight, this->framePool_->acquire());
+	image->setExposureTime(frameExposure);
+	return image;
 }
 
 // Stop acquisition process (but still holds camera instance and other resources)
@@ -140,6 +175,7 @@ bool CameraController::stopCamera() {
 
 	// End acquisition management but still need to have camera online for another run if needed
 	Picam_StopAcquisition(this->camera_);
+	this->exposureOnline_ = false;
 	
 	// Have to iterate through wait acquisition update until the running bool is false!
 	PicamAvailableData curImageData;
@@ -553,8 +589,20 @@ bool CameraController::hasCameras() {
 
 // Setter for exposure setting
 // Input: exposureTimeToSet - time to set in microseconds
-bool CameraController::SetExposure(double exposureTimeToSet) {
+//		  exposureTimeSet - if not NULL, set to the exposure the camera accepted in microseconds (read back from the camera)
+bool CameraController::SetExposure(double exposureTimeToSet, double * exposureTimeSet) {
 	// PICam deals with exposure time in milliseconds, so need to divide the input by 1000
+	// While acquiring the exposure is set online if possible (takes effect without committing)
+	if (this->exposureOnline_) {
+		if (Picam_SetParameterFloatingPointValueOnline(this->camera_, PicamParameter_ExposureTime, exposureTimeToSet / 1000) != PicamError_None) {
+			Utility::printLine("ERROR: Failed to set exposure parameter online!");
+			return false;
+		}
+		if (exposureTimeSet != NULL) {
+			*exposureTimeSet = getFloatParameterValue(PicamParameter_ExposureTime) * 1000;
+		}
+		return true;
+	}
 	PicamError errMsg = Picam_SetParameterFloatingPointValue(this->camera_, PicamParameter_ExposureTime, exposureTimeToSet / 1000);
 	if (errMsg != PicamError_None) {
 		Utility::printLine("ERROR: Failed to set exposure parameter!");
@@ -574,6 +622,9 @@ bool CameraController::SetExposure(double exposureTimeToSet) {
 	// - free picam-allocated resources
 	Picam_DestroyParameters(failed_parameters);
 
+	if (exposureTimeSet != NULL) {
+		*exposureTimeSet = getFloatParameterValue(PicamParameter_ExposureTime) * 1000;
+	}
 	return true;
 }
 
@@ -583,17 +634,28 @@ bool CameraController::ConfigureExposureTime() {
 	return SetExposure(finalExposureTime);
 }
 
-// Get the multiplier for exposure having been halved
+// Get the multiplier for exposure having been shortened
 double CameraController::GetExposureRatio() {
 	return initialExposureTime / finalExposureTime;
 }
 
-// half the current exposure time setting
-void CameraController::HalfExposureTime() {
-	finalExposureTime /= 2;
-	if (!SetExposure(finalExposureTime)) {
-		Utility::printLine("ERROR: wasn't able to half the exposure time!");
+// Get the multiplier for a frame taken with the given exposure (the current multiplier if not known)
+double CameraController::GetExposureRatio(double frameExposure) {
+	return (frameExposure > 0) ? initialExposureTime / frameExposure : GetExposureRatio();
+}
+
+// Set a new exposure time while acquiring
+bool CameraController::ChangeExposure(double exposureTime) {
+	std::unique_lock<std::mutex> lock(this->exposureMutex_);
+	double exposureSet;
+	if (!SetExposure(exposureTime, &exposureSet) || exposureSet <= 0) {
+		Utility::printLine("ERROR: wasn't able to change the exposure time!");
+		return false;
 	}
+	this->previousExposureTime_ = finalExposureTime;
+	this->exposureChangedAt_ = SteadyClock().now();
+	finalExposureTime = exposureSet;
+	return true;
 }
 
 #endif // End of PICam implementation of CameraController
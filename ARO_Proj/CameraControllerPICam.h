@@ -9,11 +9,13 @@
 #ifdef USE_PICAM
 
 #include <string>
+#include <mutex> // exposureMutex_
 
 #include "picam.h" // core include for PICam SDK
 #include "picam_advanced.h" // advanced methods (buffer management) for async continuous acquisition for faster rate
 
 #include "ImageControllerPICam.h" // Image wrapper
+#include "FrameMatcher.h" // FrameStamp & SteadyClock for synchronized acquisition
 
 class MainDialog;
 
@@ -50,6 +52,18 @@ private:
 
 
 	pibln * libraryInitialized; // library has been initialized or not
+	long long frameCounter_ = 0; // Number of frames read since startCamera() (frame id for FrameStamp)
+	// Readout geometry, cached by startCamera() as it can't change while acquiring
+	piint frameSize_ = 0;		// Bytes of image data in a readout
+	piint readoutStride_ = 0;	// Bytes from one readout to the next (image and meta data)
+	std::shared_ptr<FrameBufferPool> framePool_; // 16 bit frame buffers handed out by AcquireImage()
+	// True while acquiring if the exposure can be set without stopping (set by startCamera(), cleared by stopCamera())
+	bool exposureOnline_ = false;
+	// Exposure before the latest change and when the change was made (SteadyClock ns), to tell the exposure of each frame
+	// Guarded by exposureMutex_ along with finalExposureTime during a run, as changes come from the threads processing frames
+	double previousExposureTime_ = 0;
+	long long exposureChangedAt_ = 0;
+	std::mutex exposureMutex_;
 
 	// private methods to make easier in getting parameter values
 	piint getIntParameterValue(PicamParameter parameter);
@@ -65,6 +79,8 @@ public:
 	bool startCamera();
 	bool saveImage(ImageController * curImage, std::string path);
 	ImageController* AcquireImage();
+	// Get one image along with its frame id and exposure start in the host SteadyClock timebase (for FrameMatcher)
+	ImageController* AcquireImage(FrameStamp & stamp);
 	bool stopCamera();
 	bool shutdownCamera();
 
@@ -83,11 +99,17 @@ public:
 	// Return true if this controller has access to at least one camera
 	bool hasCameras();
 	// Setter for exposure setting
-	bool SetExposure(double exposureTimeToSet);
-	// Get the multiplier for exposure having been halved
+	// Input: exposureTimeToSet - exposure in microseconds
+	//		  exposureTimeSet - if not NULL, set to the exposure the camera accepted (read back from the camera)
+	bool SetExposure(double exposureTimeToSet, double * exposureTimeSet = NULL);
+	// Get the multiplier for exposure having been shortened
 	double GetExposureRatio();
-	// half the current exposure time setting
-	void HalfExposureTime();
+	// Ratio of the initial exposure to the exposure of a frame (its getExposureTime()), the current ratio if frameExposure is not known (0)
+	double GetExposureRatio(double frameExposure);
+	// Change the exposure during a run, frames taken from then on are marked with the new exposure
+	// Input: exposureTime - new exposure in microseconds
+	// Output: finalExposureTime set to the exposure the camera accepted, false if the camera could not be set
+	bool ChangeExposure(double exposureTime);
 };
 
 #endif
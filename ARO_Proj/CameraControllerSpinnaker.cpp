@@ -42,6 +42,8 @@ bool CameraController::setupCamera() {
 	if (!UpdateImageParameters()) {
 		return false;
 	}
+	// Exposure node is looked up again on the camera as configured now
+	this->exposureNode_ = NULL;
 	// Check for any possible issue with camera and restart if needed
 	if (!cam->IsValid() || !cam->IsInitialized()) {
 		shutdownCamera();
@@ -94,9 +96,29 @@ bool CameraController::startCamera() {
 		else {
 			ptrSBufferHandler->SetIntValue(Spinnaker::StreamBufferHandlingMode_NewestOnly);
 		}
+		// Frames beyond the views that may be held are copied into pooled buffers (two camera buffers are left for acquisition)
+		CIntegerPtr ptrBufferCount = TLnodeMap.GetNode("StreamBufferCountResult");
+		if (IsAvailable(ptrBufferCount) && IsReadable(ptrBufferCount)) {
+			this->maxHeldFrames_ = int(ptrBufferCount->GetValue()) - 2;
+		}
+		else {
+			this->maxHeldFrames_ = 0;
+		}
+		const size_t frameBytes = size_t(this->cameraImageWidth) * size_t(this->cameraImageHeight);
+		if (!this->framePool_ || this->framePool_->getBufferSize() != frameBytes) {
+			this->framePool_ = std::make_shared<FrameBufferPool>(frameBytes);
+		}
+
+		// Frames are marked with the exposure they were taken with
+		enableExposureChunk();
+		this->previousExposureTime_ = this->finalExposureTime;
+		this->exposureChangedAt_ = 0;
+
 		//Begin Aquisition
 		cam->BeginAcquisition();
 		Utility::printLine("INFO: Successfully began acquiring images!");
+		// Relate frame timestamps to the host clock for synchronized acquisition
+		syncDeviceClock();
 	}
 	catch (Spinnaker::Exception &e)	{
 		Utility::printLine("ERROR: Camera could not start - /n" + std::string(e.what()));
@@ -113,6 +135,7 @@ bool CameraController::stopCamera() {
 //Releases camera references - have to call setup camera again if need to use camer after this call
 bool CameraController::shutdownCamera() {
 	//release camera
+	this->exposureNode_ = NULL;
 	cam->DeInit();
 	//release system
 	cam = NULL;
@@ -144,9 +167,37 @@ bool CameraController::saveImage(ImageController * curImage, std::string path) {
 
 //AcquireImages: get one image from the camera
 ImageController * CameraController::AcquireImage() {
+	FrameStamp stamp;
+	return AcquireImage(stamp);
+}
+
+// AcquireImage: get one image from the camera along with its timing
+// Input: stamp - set to the frame id and exposure of the image, the exposure start is in the host SteadyClock timebase
+//				  (from the camera timestamp if it could be latched, otherwise conservatively estimated from arrival)
+// Output: the image, NULL if an error occurred
+ImageController * CameraController::AcquireImage(FrameStamp & stamp) {
 	try {
 		// Retrieve next received image
 		Spinnaker::ImagePtr curImage = cam->GetNextImage();
+		const long long received = SteadyClock().now();
+		stamp.frame_id = (long long)(curImage->GetFrameID());
+		// Exposure of the frame from its chunk data, otherwise the exposure in effect a frame period before arrival (when it was exposing)
+		double frameExposure;
+		{
+			std::unique_lock<std::mutex> lock(this->exposureMutex_);
+			frameExposure = (received - (long long)(1e9 / this->fps) >= this->exposureChangedAt_) ? this->finalExposureTime : this->previousExposureTime_;
+		}
+		if (this->hasExposureChunk_) {
+			frameExposure = double(curImage->GetChunkData().GetExposureTime());
+		}
+		stamp.exposure = (long long)(frameExposure * 1000);
+		if (this->hasDeviceClock_) {
+			stamp.exposure_start = (long long)(curImage->GetTimeStamp()) + this->deviceClockOffset_;
+		}
+		else {
+			// Exposure started no later than a frame period plus the exposure before arrival
+			stamp.exposure_start = received - stamp.exposure - (long long)(1e9 / this->fps);
+		}
 
 		// Ensure image completion
 		if (curImage->IsIncomplete()) {
@@ -154,13 +205,36 @@ ImageController * CameraController::AcquireImage() {
 			Utility::printLine("ERROR: Image incomplete: " + std::string(Spinnaker::Image::GetImageStatusDescription(curImage->GetImageStatus())));
 		}
 		
-		// Assign the converted output image to outImage, since this is a converted image we don't need to release it
-			// Resource reference says so in example conversion to mono 8 -> http://softwareservices.flir.com/Spinnaker/latest/_acquisition_8cpp-example.html
-		ImageController* outImage = new ImageController(curImage->Convert(Spinnaker::PixelFormat_Mono8), false);
+		// Mono8 (set by ConfigureCustomImageSettings) and the 16 and packed 12 bit mono formats are read natively by the fitness,
+		// hand out the camera buffer itself while buffers can be spared
+		const Spinnaker::PixelFormatEnums format = curImage->GetPixelFormat();
+		const bool isNative = (format == Spinnaker::PixelFormat_Mono8 || format == Spinnaker::PixelFormat_Mono16 || format == Spinnaker::PixelFormat_Mono12p);
+		if (isNative && this->heldFrames_->load() < this->maxHeldFrames_) {
+			ImageController * view = new ImageController(curImage, this->heldFrames_);
+			view->setExposureTime(frameExposure);
+			return view;
+		}
+
+		// Otherwise copy (or convert other formats to Mono8) into a pooled buffer and release the camera buffer right away
+		const size_t width = curImage->GetWidth(), height = curImage->GetHeight();
+		const size_t frameBytes = isNative ? curImage->GetImageSize() : width * height;
+		if (frameBytes != this->framePool_->getBufferSize()) {
+			this->framePool_ = std::make_shared<FrameBufferPool>(frameBytes);
+		}
+		PooledBuffer buffer = this->framePool_->acquire();
+		Spinnaker::ImagePtr pooledImage = Spinnaker::Image::Create(width, height, 0, 0, isNative ? format : Spinnaker::PixelFormat_Mono8, buffer.get());
+		if (isNative) {
+			memcpy(buffer.get(), curImage->GetData(), frameBytes);
+		}
+		else {
+			curImage->Convert(pooledImage, Spinnaker::PixelFormat_Mono8);
+		}
 		// Release from the buffer
 		curImage->Release();
 
-		return outImage;
+		ImageController * pooled = new ImageController(pooledImage, std::move(buffer));
+		pooled->setExposureTime(frameExposure);
+		return pooled;
 	}
 	catch (Spinnaker::Exception &e) {
 		Utility::printLine("ERROR: " + std::string(e.what()));
@@ -168,6 +242,66 @@ ImageController * CameraController::AcquireImage() {
 	}
 }
 
+// Latch the camera timestamp against the host clock so frame timestamps can be converted to host time
+// Output: true if the camera supports latching its timestamp (deviceClockOffset_ set), false if frame times will be estimated
+bool CameraController::syncDeviceClock() {
+	this->hasDeviceClock_ = false;
+	try {
+		INodeMap &nodeMap = cam->GetNodeMap();
+		CCommandPtr ptrLatch = nodeMap.GetNode("TimestampLatch");
+		CIntegerPtr ptrLatchValue = nodeMap.GetNode("TimestampLatchValue");
+		if (!IsAvailable(ptrLatch) || !IsWritable(ptrLatch) || !IsAvailable(ptrLatchValue) || !IsReadable(ptrLatchValue)) {
+			Utility::printLine("WARNING: Camera timestamp can not be latched, frame times will be estimated from arrival");
+			return false;
+		}
+		// Host time of the latch taken as the middle of the command
+		const long long before = SteadyClock().now();
+		ptrLatch->Execute();
+		const long long after = SteadyClock().now();
+		this->deviceClockOffset_ = before + (after - before) / 2 - (long long)(ptrLatchValue->GetValue());
+		this->hasDeviceClock_ = true;
+	}
+	catch (Spinnaker::Exception &e) {
+		Utility::printLine("WARNING: Could not latch camera timestamp - " + std::string(e.what()));
+		return false;
+	}
+	return true;
+}
+
+// Turn on the ExposureTime chunk so each frame records the exposure it was taken with
+// Output: true if enabled (hasExposureChunk_ set), false if frame exposures will be told from when the exposure was changed
+bool CameraController::enableExposureChunk() {
+	this->hasExposureChunk_ = false;
+	try {
+		INodeMap &nodeMap = cam->GetNodeMap();
+		CBooleanPtr ptrChunkModeActive = nodeMap.GetNode("ChunkModeActive");
+		CEnumerationPtr ptrChunkSelector = nodeMap.GetNode("ChunkSelector");
+		if (!IsAvailable(ptrChunkModeActive) || !IsWritable(ptrChunkModeActive) || !IsAvailable(ptrChunkSelector) || !IsWritable(ptrChunkSelector)) {
+			Utility::printLine("WARNING: Camera has no chunk data, frame exposures will be told from when the exposure was changed");
+			return false;
+		}
+		ptrChunkModeActive->SetValue(true);
+		CEnumEntryPtr ptrExposureEntry = ptrChunkSelector->GetEntryByName("ExposureTime");
+		if (!IsAvailable(ptrExposureEntry) || !IsReadable(ptrExposureEntry)) {
+			Utility::printLine("WARNING: Camera has no exposure time chunk, frame exposures will be told from when the exposure was changed");
+			return false;
+		}
+		ptrChunkSelector->SetIntValue(ptrExposureEntry->GetValue());
+		CBooleanPtr ptrChunkEnable = nodeMap.GetNode("ChunkEnable");
+		if (!IsAvailable(ptrChunkEnable) || !IsWritable(ptrChunkEnable)) {
+			Utility::printLine("WARNING: Unable to enable the exposure time chunk, frame exposures will be told from when the exposure was changed");
+			return false;
+		}
+		ptrChunkEnable->SetValue(true);
+		this->hasExposureChunk_ = true;
+	}
+	catch (Spinnaker::Exception &e) {
+		Utility::printLine("WARNING: Could not enable exposure time chunk - " + std::string(e.what()));
+		return false;
+	}
+	return true;
+}
+
 // [CAMERA SETUP]
 // Pull camera settings from CameraControlDialog and AOIControlDialog
 bool CameraController::UpdateImageParameters() {
@@ -565,42 +699,57 @@ double CameraController::GetExposureRatio() {
 	return initialExposureTime / finalExposureTime;
 }
 
+// GetExposureRatio: ratio for a frame taken with the given exposure
+// @param frameExposure - exposure of the frame in microseconds, 0 if not known
+// @returns - the ratio of starting and frame exposure time (of the final exposure time if not known)
+double CameraController::GetExposureRatio(double frameExposure) {
+	return (frameExposure > 0) ? initialExposureTime / frameExposure : GetExposureRatio();
+}
+
 /* SetExposure: configure a custom exposure time. Automatic exposure is turned off, then the custom setting is applied.
 * @param exposureTimeToSet - self explanatory (in microseconds = 10^-6 seconds)
+* @param exposureTimeSet - if not NULL, set to the exposure the camera accepted (read back from the node, after clamping and rounding)
 * @return FALSE if failed, TRUE if succeded */
-bool CameraController::SetExposure(double exposureTimeToSet) {
+bool CameraController::SetExposure(double exposureTimeToSet, double * exposureTimeSet) {
 	//Constraint exposure time from going lower than camera limit
 	//TODO: determine this lower bound for the camera we are using
 
 	try {
-		INodeMap &nodeMap = cam->GetNodeMap();
-
-		// Turn off automatic exposure mode
-		CEnumerationPtr ptrExposureAuto = nodeMap.GetNode("ExposureAuto");
-		if (!IsAvailable(ptrExposureAuto) || !IsWritable(ptrExposureAuto)) {
-			Utility::printLine("Unable to disable automatic exposure (node retrieval)");
-			return false;
-		}
-		CEnumEntryPtr ptrExposureAutoOff = ptrExposureAuto->GetEntryByName("Off");
-		if (!IsAvailable(ptrExposureAutoOff) || !IsReadable(ptrExposureAutoOff)) {
-			Utility::printLine("Unable to disable automatic exposure (enum entry retrieval)");
-			return false;
-		}
-		ptrExposureAuto->SetIntValue(ptrExposureAutoOff->GetValue());
+		// Lookup of the nodes is done once, changes during a run only set the cached node
+		if (!this->exposureNode_.IsValid()) {
+			INodeMap &nodeMap = cam->GetNodeMap();
+
+			// Turn off automatic exposure mode
+			CEnumerationPtr ptrExposureAuto = nodeMap.GetNode("ExposureAuto");
+			if (!IsAvailable(ptrExposureAuto) || !IsWritable(ptrExposureAuto)) {
+				Utility::printLine("Unable to disable automatic exposure (node retrieval)");
+				return false;
+			}
+			CEnumEntryPtr ptrExposureAutoOff = ptrExposureAuto->GetEntryByName("Off");
+			if (!IsAvailable(ptrExposureAutoOff) || !IsReadable(ptrExposureAutoOff)) {
+				Utility::printLine("Unable to disable automatic exposure (enum entry retrieval)");
+				return false;
+			}
+			ptrExposureAuto->SetIntValue(ptrExposureAutoOff->GetValue());
 
-		// Set exposure manually
-		CFloatPtr ptrExposureTime = nodeMap.GetNode("ExposureTime");
-		if (!IsAvailable(ptrExposureTime) || !IsWritable(ptrExposureTime)) {
-			Utility::printLine("ERROR: Unable to set exposure time.");
-			return false;
+			// Set exposure manually
+			CFloatPtr ptrExposureTime = nodeMap.GetNode("ExposureTime");
+			if (!IsAvailable(ptrExposureTime) || !IsWritable(ptrExposureTime)) {
+				Utility::printLine("ERROR: Unable to set exposure time.");
+				return false;
+			}
+			this->exposureNode_ = ptrExposureTime;
+			this->exposureMax_ = ptrExposureTime->GetMax();
 		}
 		// Ensure new time does not exceed max set to max if does
-		const double exposureTimeMax = ptrExposureTime->GetMax();
-		if (exposureTimeToSet > exposureTimeMax) {
-			exposureTimeToSet = exposureTimeMax;
-			Utility::printLine("WARNING: Exposure time of " + std::to_string(exposureTimeToSet) + " is to big. Exposure set too max of " + std::to_string(exposureTimeMax));
+		if (exposureTimeToSet > this->exposureMax_) {
+			exposureTimeToSet = this->exposureMax_;
+			Utility::printLine("WARNING: Exposure time of " + std::to_string(exposureTimeToSet) + " is to big. Exposure set too max of " + std::to_string(this->exposureMax_));
+		}
+		this->exposureNode_->SetValue(exposureTimeToSet);
+		if (exposureTimeSet != NULL) {
+			*exposureTimeSet = this->exposureNode_->GetValue();
 		}
-		ptrExposureTime->SetValue(exposureTimeToSet);
 	}
 	catch (Spinnaker::Exception &e)	{
 		Utility::printLine("ERROR: Cannot Set Exposure Time:\n" + std::string(e.what()));
@@ -610,10 +759,20 @@ bool CameraController::SetExposure(double exposureTimeToSet) {
 	return true;
 }
 
-void CameraController::HalfExposureTime() {
-	finalExposureTime /= 2;
-	if (!SetExposure(finalExposureTime))
-		Utility::printLine("ERROR: wasn't able to half the exposure time!");
+// ChangeExposure: set a new exposure time while acquiring
+// @param exposureTime - new exposure in microseconds
+// @return FALSE if failed, TRUE if succeded
+bool CameraController::ChangeExposure(double exposureTime) {
+	std::unique_lock<std::mutex> lock(this->exposureMutex_);
+	double exposureSet;
+	if (!SetExposure(exposureTime, &exposureSet)) {
+		Utility::printLine("ERROR: wasn't able to change the exposure time!");
+		return false;
+	}
+	this->previousExposureTime_ = finalExposureTime;
+	this->exposureChangedAt_ = SteadyClock().now();
+	finalExposureTime = exposureSet;
+	return true;
 }
 
 // [ACCESSOR(S)/MUTATOR(S)]
@@ -9,6 +9,7 @@
 #ifdef USE_SPINNAKER
 
 #include <string>
+#include <mutex>	// exposureMutex_
 
 #include "Spinnaker.h"
 #include "SpinGenApi\SpinnakerGenApi.h"
@@ -16,6 +17,7 @@ using namespace Spinnaker::GenApi;
 using namespace Spinnaker::GenICam;
 
 #include "ImageControllerSpinnaker.h"	// For wrapping the input/output of image data
+#include "FrameMatcher.h"				// FrameStamp & SteadyClock for synchronized acquisition
 
 class MainDialog;
 
@@ -53,6 +55,32 @@ private:
 
 	//Logic control
 	bool isCamCreated = false;
+
+	// Offset from the camera's timestamp clock to the host SteadyClock (ns), valid if hasDeviceClock_
+	long long deviceClockOffset_ = 0;
+	bool hasDeviceClock_ = false;
+	// Frames handed out by AcquireImage(): Mono8 frames are views of the camera buffers (released when the ImageController is deleted)
+	// while fewer than maxHeldFrames_ are held, otherwise frames are copied or converted into buffers from framePool_
+	std::shared_ptr<FrameBufferPool> framePool_;
+	std::shared_ptr<std::atomic<int>> heldFrames_ = std::make_shared<std::atomic<int>>(0);
+	int maxHeldFrames_ = 0;
+	// ExposureTime node and its maximum, looked up by the first SetExposure() after setupCamera() (automatic exposure is turned off then)
+	CFloatPtr exposureNode_;
+	double exposureMax_ = 0;
+	// True if frames carry their exposure time as chunk data (enabled by startCamera() when the camera supports it)
+	bool hasExposureChunk_ = false;
+	// Exposure before the latest change and when the change was made (SteadyClock ns), to tell the exposure of frames without chunk data
+	// Guarded by exposureMutex_ along with finalExposureTime during a run, as changes come from the threads processing frames
+	double previousExposureTime_ = 0;
+	long long exposureChangedAt_ = 0;
+	std::mutex exposureMutex_;
+
+	// Latch the camera timestamp against the host clock to set deviceClockOffset_ (called by startCamera())
+	// Output: true if the camera supports latching its timestamp
+	bool syncDeviceClock();
+	// Have the camera attach the exposure time to every frame (called by startCamera())
+	// Output: true if the camera supports exposure time chunk data
+	bool enableExposureChunk();
 public:
 
 	CameraController(MainDialog* dlg_);
@@ -62,6 +90,8 @@ public:
 	bool startCamera();
 	bool saveImage(ImageController * curImage, std::string path);
 	ImageController* AcquireImage();
+	// Get one image along with its frame id and exposure start in the host SteadyClock timebase (for FrameMatcher)
+	ImageController* AcquireImage(FrameStamp & stamp);
 	bool stopCamera();
 	bool shutdownCamera();
 
@@ -76,9 +106,16 @@ public:
 	// Return true if this controller has access to at least one camera
 	bool hasCameras(); 
 
-	bool SetExposure(double exposureTimeToSet);
+	// Input: exposureTimeToSet - exposure in microseconds (clamped to the camera maximum)
+	//		  exposureTimeSet - if not NULL, set to the exposure the camera accepted (read back from the camera)
+	bool SetExposure(double exposureTimeToSet, double * exposureTimeSet = NULL);
 	double GetExposureRatio();
-	void HalfExposureTime();
+	// Ratio of the initial exposure to the exposure of a frame (its getExposureTime()), the current ratio if frameExposure is not known (0)
+	double GetExposureRatio(double frameExposure);
+	// Change the exposure during a run, frames taken from then on are marked with the new exposure
+	// Input: exposureTime - new exposure in microseconds
+	// Output: finalExposureTime set to the exposure the camera accepted (after clamping), false if the camera could not be set
+	bool ChangeExposure(double exposureTime);
 
 	// [ACCESSOR(S)/MUTATOR(S)]
 	bool GetCenter(int &x, int &y);
@@ -0,0 +1,221 @@
+////////////////////
+// CrossoverKernel.h - vectorized uniform crossover and mutation used by Population::Crossover()
+////////////////////
+
+#ifndef CROSSOVER_KERNEL_H_
+#define CROSSOVER_KERNEL_H_
+
+#include "FastRandom.h"	// bits64() & uniform() for the random masks
+#include "GenomeTraits.h"	// randomGene() for mutated values
+#include <cmath>			// std::log() & std::floor() in mutate()
+
+// Instruction set is chosen at compile time, AVX2 when building with /arch:AVX2 otherwise SSE2 (always present on x64)
+// Define CROSSOVER_FORCE_SCALAR to use the plain C++ path
+#if !defined(CROSSOVER_FORCE_SCALAR) && defined(__AVX2__)
+#define CROSSOVER_AVX2
+#include <immintrin.h>
+#elif !defined(CROSSOVER_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define CROSSOVER_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace CrossoverKernel {
+	// Number of genes that share one 64 bit random word of parent choices
+	const int BLOCK_GENES = 64;
+
+	// Unsigned integer type of the same size as a gene, the kernels only move and compare bits
+	template <int Size> struct GeneWord { };
+	template <> struct GeneWord<1> { typedef unsigned char type; };
+	template <> struct GeneWord<2> { typedef unsigned short type; };
+	template <> struct GeneWord<4> { typedef unsigned int type; };
+
+	// Count of set bits
+	inline int popCount(unsigned int x) {
+#if defined(CROSSOVER_AVX2)
+		return _mm_popcnt_u32(x);
+#else
+		x = x - ((x >> 1) & 0x55555555u);
+		x = (x & 0x33333333u) + ((x >> 2) & 0x33333333u);
+		return int((((x + (x >> 4)) & 0x0F0F0F0Fu) * 0x01010101u) >> 24);
+#endif
+	}
+
+	// Blend one block of 64 genes, bit k of mask set takes gene k from a otherwise from b
+	// Input:
+	//	a, b - parent genomes (at least BLOCK_GENES genes)
+	//	out	 - child genome
+	//	mask - parent choices
+	// Output: out holds the child, returns how many genes are equal in a and b
+	template <class U>
+	int blendBlockScalar(const U * a, const U * b, U * out, unsigned long long mask) {
+		int same = 0;
+		for (int k = 0; k < BLOCK_GENES; k++) {
+			out[k] = ((mask >> k) & 1) ? a[k] : b[k];
+			same += (a[k] == b[k]);
+		}
+		return same;
+	}
+
+#if defined(CROSSOVER_AVX2)
+	// 8 bit genes, 32 per vector
+	inline int blendBlock(const unsigned char * a, const unsigned char * b, unsigned char * out, unsigned long long mask) {
+		const __m256i bits = _mm256_set1_epi64x(0x8040201008040201ll);
+		const unsigned long long rep = 0x0101010101010101ull;
+		int same = 0;
+		for (int v = 0; v < 2; v++, mask >>= 32) {
+			// Replicate each mask byte over 8 lanes, then isolate one bit per lane
+			const __m256i m = _mm256_cmpeq_epi8(_mm256_and_si256(_mm256_set_epi64x(
+				(long long)(((mask >> 24) & 0xFF) * rep), (long long)(((mask >> 16) & 0xFF) * rep),
+				(long long)(((mask >> 8) & 0xFF) * rep), (long long)((mask & 0xFF) * rep)), bits), bits);
+			const __m256i va = _mm256_loadu_si256((const __m256i*)(a + 32 * v));
+			const __m256i vb = _mm256_loadu_si256((const __m256i*)(b + 32 * v));
+			_mm256_storeu_si256((__m256i*)(out + 32 * v), _mm256_blendv_epi8(vb, va, m));
+			same += popCount(unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb))));
+		}
+		return same;
+	}
+
+	// 16 bit genes, 16 per vector
+	inline int blendBlock(const unsigned short * a, const unsigned short * b, unsigned short * out, unsigned long long mask) {
+		const __m256i bits = _mm256_setr_epi16(0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80,
+			0x100, 0x200, 0x400, 0x800, 0x1000, 0x2000, 0x4000, short(0x8000));
+		int same = 0;
+		for (int v = 0; v < 4; v++, mask >>= 16) {
+			const __m256i m = _mm256_cmpeq_epi16(_mm256_and_si256(_mm256_set1_epi16(short(mask & 0xFFFF)), bits), bits);
+			const __m256i va = _mm256_loadu_si256((const __m256i*)(a + 16 * v));
+			const __m256i vb = _mm256_loadu_si256((const __m256i*)(b + 16 * v));
+			_mm256_storeu_si256((__m256i*)(out + 16 * v), _mm256_blendv_epi8(vb, va, m));
+			// Two movemask bits per equal gene
+			same += popCount(unsigned(_mm256_movemask_epi8(_mm256_cmpeq_epi16(va, vb)))) >> 1;
+		}
+		return same;
+	}
+
+	// 32 bit genes, 8 per vector
+	inline int blendBlock(const unsigned int * a, const unsigned int * b, unsigned int * out, unsigned long long mask) {
+		const __m256i bits = _mm256_setr_epi32(0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80);
+		int same = 0;
+		for (int v = 0; v < 8; v++, mask >>= 8) {
+			const __m256i m = _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(int(mask & 0xFF)), bits), bits);
+			const __m256i va = _mm256_loadu_si256((const __m256i*)(a + 8 * v));
+			const __m256i vb = _mm256_loadu_si256((const __m256i*)(b + 8 * v));
+			_mm256_storeu_si256((__m256i*)(out + 8 * v), _mm256_blendv_epi8(vb, va, m));
+			same += popCount(unsigned(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(va, vb)))));
+		}
+		return same;
+	}
+#elif defined(CROSSOVER_SSE2)
+	// SSE2 has no variable blend, select with and/andnot/or
+	inline __m128i select128(const __m128i m, const __m128i a, const __m128i b) {
+		return _mm_or_si128(_mm_and_si128(m, a), _mm_andnot_si128(m, b));
+	}
+
+	// 8 bit genes, 16 per vector
+	inline int blendBlock(const unsigned char * a, const unsigned char * b, unsigned char * out, unsigned long long mask) {
+		const __m128i bits = _mm_set1_epi64x(0x8040201008040201ll);
+		const unsigned long long rep = 0x0101010101010101ull;
+		int same = 0;
+		for (int v = 0; v < 4; v++, mask >>= 16) {
+			// Replicate each mask byte over 8 lanes, then isolate one bit per lane
+			const __m128i m = _mm_cmpeq_epi8(_mm_and_si128(_mm_set_epi64x(
+				(long long)(((mask >> 8) & 0xFF) * rep), (long long)((mask & 0xFF) * rep)), bits), bits);
+			const __m128i va = _mm_loadu_si128((const __m128i*)(a + 16 * v));
+			const __m128i vb = _mm_loadu_si128((const __m128i*)(b + 16 * v));
+			_mm_storeu_si128((__m128i*)(out + 16 * v), select128(m, va, vb));
+			same += popCount(unsigned(_mm_movemask_epi8(_mm_cmpeq_epi8(va, vb))));
+		}
+		return same;
+	}
+
+	// 16 bit genes, 8 per vector
+	inline int blendBlock(const unsigned short * a, const unsigned short * b, unsigned short * out, unsigned long long mask) {
+		const __m128i bits = _mm_setr_epi16(0x1, 0x2, 0x4, 0x8, 0x10, 0x20, 0x40, 0x80);
+		int same = 0;
+		for (int v = 0; v < 8; v++, mask >>= 8) {
+			const __m128i m = _mm_cmpeq_epi16(_mm_and_si128(_mm_set1_epi16(short(mask & 0xFF)), bits), bits);
+			const __m128i va = _mm_loadu_si128((const __m128i*)(a + 8 * v));
+			const __m128i vb = _mm_loadu_si128((const __m128i*)(b + 8 * v));
+			_mm_storeu_si128((__m128i*)(out + 8 * v), select128(m, va, vb));
+			// Two movemask bits per equal gene
+			same += popCount(unsigned(_mm_movemask_epi8(_mm_cmpeq_epi16(va, vb)))) >> 1;
+		}
+		return same;
+	}
+
+	// 32 bit genes, 4 per vector
+	inline int blendBlock(const unsigned int * a, const unsigned int * b, unsigned int * out, unsigned long long mask) {
+		const __m128i bits = _mm_setr_epi32(0x1, 0x2, 0x4, 0x8);
+		int same = 0;
+		for (int v = 0; v < 16; v++, mask >>= 4) {
+			const __m128i m = _mm_cmpeq_epi32(_mm_and_si128(_mm_set1_epi32(int(mask & 0xF)), bits), bits);
+			const __m128i va = _mm_loadu_si128((const __m128i*)(a + 4 * v));
+			const __m128i vb = _mm_loadu_si128((const __m128i*)(b + 4 * v));
+			_mm_storeu_si128((__m128i*)(out + 4 * v), select128(m, va, vb));
+			same += popCount(unsigned(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(va, vb)))));
+		}
+		return same;
+	}
+#else
+	template <class U>
+	int blendBlock(const U * a, const U * b, U * out, unsigned long long mask) {
+		return blendBlockScalar(a, b, out, mask);
+	}
+#endif
+
+	// Uniform crossover of two genomes, each gene has a 50% chance of coming from either parent
+	// Input:
+	//	a, b		- parent genomes
+	//	out			- genome to write the child into
+	//	length		- number of genes
+	//	rng_machine - random generator, one 64 bit word supplies the parent choices of 64 genes
+	// Output: out holds the child, returns how many genes are equal in a and b
+	template <class T>
+	int blend(const T * a, const T * b, T * out, int length, FastRandom * rng_machine) {
+		typedef typename GeneWord<sizeof(T)>::type U;
+		const U * ua = reinterpret_cast<const U*>(a);
+		const U * ub = reinterpret_cast<const U*>(b);
+		U * uout = reinterpret_cast<U*>(out);
+
+		int same = 0;
+		int i = 0;
+		for (; i + BLOCK_GENES <= length; i += BLOCK_GENES) {
+			same += blendBlock(ua + i, ub + i, uout + i, rng_machine->bits64());
+		}
+		// Remaining genes (fewer than a block)
+		if (i < length) {
+			unsigned long long mask = rng_machine->bits64();
+			for (; i < length; i++, mask >>= 1) {
+				uout[i] = (mask & 1) ? ua[i] : ub[i];
+				same += (ua[i] == ub[i]);
+			}
+		}
+		return same;
+	}
+
+	// Mutation pass, each gene is independently replaced by a random value over the phase levels of T with chance rate
+	//	Kept separate from the blend so the blend stays branch free. Instead of a check per gene the gap to the next
+	//	mutated gene is drawn from a geometric distribution, so only the genes that mutate cost random draws
+	// Input:
+	//	genome		  - genome to mutate in place
+	//	length		  - number of genes
+	//	inv_log_keep  - 1/log(1 - rate) for the mutation rate (see Population::setMutationRate()), 0 disables mutation
+	//	rng_machine	  - random generator
+	template <class T>
+	void mutate(T * genome, int length, double inv_log_keep, FastRandom * rng_machine) {
+		if (inv_log_keep == 0) {
+			return;
+		}
+		int i = -1;
+		while (true) {
+			// Number of genes skipped before the next mutation, log(1-u) is in (-inf, 0] so the gap is not negative
+			const double gap = std::floor(std::log(1.0 - rng_machine->uniform()) * inv_log_keep);
+			if (gap >= double(length - 1 - i)) {
+				return;
+			}
+			i += int(gap) + 1;
+			genome[i] = randomGene<T>(rng_machine);
+		}
+	}
+}
+
+#endif
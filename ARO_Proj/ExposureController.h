@@ -0,0 +1,177 @@
+////////////////////
+// ExposureController.h - keeps the camera exposure below saturation in fine steps, from a cheap histogram and the trend of the target intensity
+////////////////////
+
+#ifndef EXPOSURE_CONTROLLER_H_
+#define EXPOSURE_CONTROLLER_H_
+
+#include <algorithm>	// std::min & std::max
+#include <deque>		// trend_
+
+#include "PixelTraits.h"	// Reading the frame in its native encoding
+
+// Coarse histogram of a frame on the 8 bit scale, from every step-th pixel of every step-th row
+class FrameHistogram {
+public:
+	static const int bins = 16;	// Each bin is 16 levels of the 8 bit scale wide
+	int counts[bins];
+	int total;
+
+	FrameHistogram() {
+		this->clear();
+	}
+
+	void clear() {
+		std::fill(this->counts, this->counts + bins, 0);
+		this->total = 0;
+	}
+
+	// Build from a frame
+	// Input:
+	//	image - the pixels (see PixelEncoding)
+	//	encoding - encoding of image
+	//	width, height - frame size in pixels
+	//	step - sampling step in both directions (4 reads 1 in 16 pixels)
+	void build(const void * image, PixelEncoding encoding, int width, int height, int step = 4) {
+		const unsigned char * data = static_cast<const unsigned char*>(image);
+		switch (encoding) {
+		case PixelEncoding::Mono16:
+			this->build<uint16_t>(data, width, height, step);
+			break;
+		case PixelEncoding::Mono12p:
+			this->build<Mono12Packed>(data, width, height, step);
+			break;
+		default:
+			this->build<uint8_t>(data, width, height, step);
+			break;
+		}
+	}
+
+	template <class P>
+	void build(const unsigned char * image, int width, int height, int step) {
+		this->clear();
+		step = (std::max)(step, 1);
+		const size_t rowBytes = PixelTraits<P>::rowBytes(width);
+		for (int y = 0; y < height; y += step) {
+			const unsigned char * row = image + rowBytes * y;
+			for (int x = 0; x < width; x += step) {
+				this->counts[int(PixelTraits<P>::load(row, x) * (unsigned long long)(bins) / (PixelTraits<P>::max_value + 1ull))]++;
+			}
+		}
+		for (int i = 0; i < bins; i++) {
+			this->total += this->counts[i];
+		}
+	}
+
+	// Fraction of the sampled pixels in the top bin (at or near saturation)
+	double saturatedFraction() const {
+		return (this->total > 0) ? double(this->counts[bins - 1]) / this->total : 0;
+	}
+};
+
+// Decides the exposure to use for the next individual.
+// The target mean of each frame is divided by the exposure it was taken with, giving a brightness that does not depend on the exposure.
+// A line fitted to the recent brightness predicts the next frame, and the exposure is cut once the predicted target mean
+// (or the share of saturated pixels) passes the trigger level, by just enough to bring it back to the aim level.
+// Exposure is only ever shortened, as with the halving it replaces, so fitness values stay comparable.
+// Not thread safe, the caller serializes observe().
+class ExposureController {
+private:
+	double exposure_;		// Exposure to use (us)
+	double minExposure_;	// Shortest exposure allowed (us)
+	double maxLevel_;		// Target mean that must not be reached (maxFitnessValue)
+	double trigger_;		// Fraction of maxLevel_ the predicted target mean may reach before cutting
+	double aim_;			// Fraction of maxLevel_ a cut aims the target mean at
+	double minStep_;		// Smallest relative cut worth making
+	double maxCut_;			// Smallest ratio of new to old exposure in one cut
+	double saturation_;		// Fraction of sampled pixels in the top bin treated as saturating
+	int window_;			// Frames in the trend
+	std::deque<double> trend_;	// Brightness (target mean per us of exposure) of the latest frames, oldest first
+
+	// Brightness of the next frame, from a least squares line through the trend (never less than the latest frame)
+	double predictBrightness() const {
+		const int n = int(this->trend_.size());
+		if (n < 3) {
+			return this->trend_.back();
+		}
+		double sumX = 0, sumY = 0, sumXX = 0, sumXY = 0;
+		for (int i = 0; i < n; i++) {
+			sumX += i;
+			sumY += this->trend_[i];
+			sumXX += double(i) * i;
+			sumXY += i * this->trend_[i];
+		}
+		const double slope = (n * sumXY - sumX * sumY) / (n * sumXX - sumX * sumX);
+		const double next = (sumY + slope * (n * n - sumX)) / n;	// Line evaluated at x = n
+		return (std::max)(next, this->trend_.back());
+	}
+
+public:
+	// Constructor
+	// Input:
+	//	trigger, aim - fractions of the max level to cut the exposure at and to aim for after a cut
+	//	window - number of frames the trend is fitted over
+	ExposureController(double trigger = 0.95, double aim = 0.8, int window = 8) {
+		this->exposure_ = 0;
+		this->minExposure_ = 1;
+		this->maxLevel_ = 255;
+		this->trigger_ = trigger;
+		this->aim_ = aim;
+		this->minStep_ = 0.02;
+		this->maxCut_ = 0.5;
+		this->saturation_ = 0.01;
+		this->window_ = (std::max)(window, 1);
+	}
+
+	// Start a run
+	// Input:
+	//	exposure - exposure the camera is set to (us)
+	//	maxLevel - target mean on the 8 bit scale that must not be reached
+	//	minExposure - shortest exposure to use (us)
+	void reset(double exposure, double maxLevel, double minExposure = 1) {
+		this->exposure_ = exposure;
+		this->maxLevel_ = maxLevel;
+		this->minExposure_ = minExposure;
+		this->trend_.clear();
+	}
+
+	// Record a measured frame
+	// Input:
+	//	frameExposure - exposure the frame was taken with (us), which may be older than getExposure() for frames in flight
+	//	targetMean - mean of the target on the 8 bit scale (from FitnessFunction::evaluate())
+	//	histogram - histogram of the frame
+	// Output: exposure to use from now on (us), getExposure() if no change is needed
+	double observe(double frameExposure, double targetMean, const FrameHistogram & histogram) {
+		if (frameExposure <= 0) {
+			frameExposure = this->exposure_;
+		}
+		this->trend_.push_back(targetMean / frameExposure);
+		if (int(this->trend_.size()) > this->window_) {
+			this->trend_.pop_front();
+		}
+		// A saturated frame taken before the last cut says nothing about the current exposure
+		const bool saturated = histogram.saturatedFraction() > this->saturation_ && frameExposure <= this->exposure_;
+		const double predicted = this->predictBrightness() * this->exposure_;
+		if (predicted <= this->trigger_ * this->maxLevel_ && !saturated) {
+			return this->exposure_;
+		}
+		// Cut to bring the predicted mean to the aim level, a saturated frame with a low mean (a small hot spot) gets a fixed step
+		double ratio = (predicted > 0) ? this->aim_ * this->maxLevel_ / predicted : 1;
+		if (saturated) {
+			ratio = (std::min)(ratio, 1 - 4 * this->minStep_);
+		}
+		ratio = (std::max)(ratio, this->maxCut_);
+		const double exposure = (std::max)(this->exposure_ * ratio, this->minExposure_);
+		if (exposure < this->exposure_ * (1 - this->minStep_)) {
+			this->exposure_ = exposure;
+		}
+		return this->exposure_;
+	}
+
+	// Exposure to use (us)
+	const double getExposure() const {
+		return this->exposure_;
+	}
+};
+
+#endif
@@ -0,0 +1,165 @@
+////////////////////
+// FastRandom.h - project's randomizer, small state xoshiro256** generator with per-thread streams and bulk fills
+////////////////////
+
+#ifndef FAST_RANDOM_H_
+#define FAST_RANDOM_H_
+
+#include <cstdint>	// uint64_t & friends
+#include <cstring>	// memcpy() in fill()
+#include <cstddef>	// size_t
+#include <new>		// placement new in createStreams()
+#include <malloc.h>	// _aligned_malloc() & _aligned_free()
+#include <random>	// std::random_device in randomSeed()
+
+// xoshiro256** (Blackman & Vigna), 256 bits of state and a period of 2^256-1
+// Instances are aligned and padded to a cache line so per-thread streams placed in an array never share a line
+// Explicitly seeded runs are reproducible, seeding goes through SplitMix64 so nearby seeds give unrelated streams
+class alignas(64) FastRandom {
+private:
+	uint64_t s_[4];
+
+	static inline uint64_t rotl(const uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+
+	// SplitMix64 step, used to expand a 64 bit seed into the generator state
+	static inline uint64_t splitMix64(uint64_t & x) {
+		uint64_t z = (x += 0x9E3779B97F4A7C15ull);
+		z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+		z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+		return z ^ (z >> 31);
+	}
+
+public:
+	// Constructor
+	// Input: seed - value to seed with, 0 draws a seed from std::random_device (see randomSeed())
+	FastRandom(uint64_t seed = 0) {
+		this->seed(seed);
+	}
+
+	// Draw a non-zero seed from std::random_device, used when a run has no explicit seed
+	static uint64_t randomSeed() {
+		std::random_device rd;
+		uint64_t seed = 0;
+		while (seed == 0) {
+			seed = (uint64_t(rd()) << 32) | rd();
+		}
+		return seed;
+	}
+
+	// Reset the state from a seed
+	// Input: seed - value to seed with, 0 draws a seed from std::random_device
+	void seed(uint64_t seed) {
+		if (seed == 0) {
+			seed = randomSeed();
+		}
+		for (int i = 0; i < 4; i++) {
+			this->s_[i] = splitMix64(seed);
+		}
+	}
+
+	// Next 64 random bits
+	inline uint64_t next() {
+		const uint64_t result = rotl(this->s_[1] * 5, 7) * 9;
+		const uint64_t t = this->s_[1] << 17;
+		this->s_[2] ^= this->s_[0];
+		this->s_[3] ^= this->s_[1];
+		this->s_[1] ^= this->s_[2];
+		this->s_[0] ^= this->s_[3];
+		this->s_[2] ^= t;
+		this->s_[3] = rotl(this->s_[3], 45);
+		return result;
+	}
+
+	// Same as next(), 64 random bits
+	inline uint64_t bits64() {
+		return this->next();
+	}
+
+	// Uniform random number in [0,1) with 53 bits of resolution
+	inline double uniform() {
+		return (this->next() >> 11) * (1.0 / 9007199254740992.0);
+	}
+
+	// Uniform random integer in [0, range) without modulo bias (Lemire's multiply and reject)
+	// Input: range - number of possible values (at least 1)
+	inline uint32_t bounded(uint32_t range) {
+		uint64_t m = (this->next() >> 32) * range;
+		uint32_t low = uint32_t(m);
+		if (low < range) {
+			const uint32_t threshold = uint32_t(0u - range) % range;
+			while (low < threshold) {
+				m = (this->next() >> 32) * range;
+				low = uint32_t(m);
+			}
+		}
+		return uint32_t(m >> 32);
+	}
+
+	// Fill a buffer with random bytes, 8 bytes per generator step
+	// Input: out - buffer to fill
+	//		  n - number of bytes
+	void fill(uint8_t * out, size_t n) {
+		size_t i = 0;
+		for (; i + 8 <= n; i += 8) {
+			const uint64_t word = this->next();
+			memcpy(out + i, &word, 8);
+		}
+		if (i < n) {
+			const uint64_t word = this->next();
+			memcpy(out + i, &word, n - i);
+		}
+	}
+
+	// Fill an array of words with random bits (such as 64 gene parent choice masks)
+	// Input: out - words to fill
+	//		  words - number of words
+	void fill_bits(uint64_t * out, size_t words) {
+		for (size_t i = 0; i < words; i++) {
+			out[i] = this->next();
+		}
+	}
+
+	// Advance the state by 2^128 steps, streams separated by jumps never overlap in practice
+	void jump() {
+		static const uint64_t JUMP[] = { 0x180ec6d33cfd0abaull, 0xd5a61266f0c9392cull, 0xa9582618e03fc9aaull, 0x39abdc4529b1661cull };
+		uint64_t s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+		for (int i = 0; i < 4; i++) {
+			for (int b = 0; b < 64; b++) {
+				if (JUMP[i] & (uint64_t(1) << b)) {
+					s0 ^= this->s_[0];
+					s1 ^= this->s_[1];
+					s2 ^= this->s_[2];
+					s3 ^= this->s_[3];
+				}
+				this->next();
+			}
+		}
+		this->s_[0] = s0;
+		this->s_[1] = s1;
+		this->s_[2] = s2;
+		this->s_[3] = s3;
+	}
+
+	// Create an array of independent streams (one per thread), stream i is the seeded generator jumped i times
+	// Input: seed - seed of the first stream (0 draws one from std::random_device)
+	//		  count - number of streams
+	// Output: cache line aligned array, release with destroyStreams()
+	static FastRandom * createStreams(uint64_t seed, int count) {
+		FastRandom * streams = static_cast<FastRandom*>(_aligned_malloc(sizeof(FastRandom) * count, alignof(FastRandom)));
+		FastRandom base(seed);
+		for (int i = 0; i < count; i++) {
+			new (&streams[i]) FastRandom(base);
+			base.jump();
+		}
+		return streams;
+	}
+
+	// Release an array made by createStreams()
+	static void destroyStreams(FastRandom * streams) {
+		_aligned_free(streams);
+	}
+};
+
+#endif
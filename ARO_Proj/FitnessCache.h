@@ -0,0 +1,165 @@
+////////////////////
+// FitnessCache.h - cache of measured fitness keyed by a hash of the genomes, used to skip redundant hardware evaluations
+////////////////////
+
+#ifndef FITNESS_CACHE_H_
+#define FITNESS_CACHE_H_
+
+#include <cstdint>			// uint64_t
+#include <cstring>			// memcpy() in hashGenome()
+#include <unordered_map>	// entries_
+#include <mutex>			// mutex_, individuals are evaluated by several threads
+
+// Measured fitness for a set of genomes (one per board) keyed by a 64 bit hash
+// An entry is only used while the camera is at the exposure it was measured with and for at most ttl generations,
+// so slow drift of the setup and exposure changes are picked up by measuring again
+// Both lookup() and store() are given the exposure ratio of the camera settings (CameraController::GetExposureRatio()),
+// not that of a frame, so the two compare equal while the exposure is unchanged
+class FitnessCache {
+private:
+	struct Entry {
+		double fitness;			// Fitness as recorded for the individual (already scaled by the exposure ratio)
+		double exposure_ratio;	// Exposure ratio of the camera when stored
+		int generation;			// Generation when measured
+	};
+	std::unordered_map<uint64_t, Entry> entries_;
+	std::mutex mutex_;
+
+	// Number of generations an entry stays valid (0 disables the cache)
+	int ttl_;
+	// If more entries than this are still valid at the end of a generation the cache is cleared
+	size_t max_entries_;
+
+	// Counters for the current generation and total hits over the run
+	int hits_, misses_;
+	long long total_hits_;
+
+	static inline uint64_t rotl(const uint64_t x, int k) {
+		return (x << k) | (x >> (64 - k));
+	}
+
+public:
+	// Constructor
+	// Input:
+	//	ttl - number of generations an entry stays valid (0 disables the cache)
+	//	max_entries - bound on the number of entries kept
+	FitnessCache(int ttl = 10, size_t max_entries = 1 << 16) {
+		this->reset(ttl, max_entries);
+	}
+
+	// Clear all entries and counters (start of a run)
+	void reset(int ttl, size_t max_entries = 1 << 16) {
+		std::unique_lock<std::mutex> lock(this->mutex_);
+		this->entries_.clear();
+		this->ttl_ = ttl;
+		this->max_entries_ = max_entries;
+		this->hits_ = this->misses_ = 0;
+		this->total_hits_ = 0;
+	}
+
+	// True if entries are used (ttl is positive)
+	const bool isEnabled() const {
+		return this->ttl_ > 0;
+	}
+
+	// Fast 64 bit hash of a genome, chain seed through the genomes of every board to get one key for an individual
+	// Input:
+	//	genome - genome data
+	//	bytes - size of the genome in bytes
+	//	seed - previous hash when combining several genomes (0 for the first)
+	// Output: hash of the genome combined with seed
+	static uint64_t hashGenome(const void * genome, size_t bytes, uint64_t seed = 0) {
+		const uint64_t P1 = 0x9E3779B185EBCA87ull, P2 = 0xC2B2AE3D27D4EB4Full, P3 = 0x165667B19E3779F9ull;
+		const unsigned char * p = static_cast<const unsigned char*>(genome);
+		// Four independent lanes so the multiplies overlap
+		uint64_t acc[4] = { seed + P1 + P2, seed + P2, seed, seed - P1 };
+		size_t i = 0;
+		for (; i + 32 <= bytes; i += 32) {
+			for (int lane = 0; lane < 4; lane++) {
+				uint64_t word;
+				memcpy(&word, p + i + 8 * lane, 8);
+				acc[lane] = rotl(acc[lane] + word * P2, 31) * P1;
+			}
+		}
+		uint64_t h = rotl(acc[0], 1) + rotl(acc[1], 7) + rotl(acc[2], 12) + rotl(acc[3], 18) + bytes;
+		for (; i + 8 <= bytes; i += 8) {
+			uint64_t word;
+			memcpy(&word, p + i, 8);
+			h = rotl(h ^ (rotl(word * P2, 31) * P1), 27) * P1 + P3;
+		}
+		for (; i < bytes; i++) {
+			h = rotl(h ^ (p[i] * P3), 11) * P1;
+		}
+		// Final avalanche
+		h ^= h >> 33;
+		h *= P2;
+		h ^= h >> 29;
+		h *= P3;
+		h ^= h >> 32;
+		return h;
+	}
+
+	// Look up a measured fitness, counts a hit or a miss for the generation
+	// Input:
+	//	key - hash of the genomes (see hashGenome())
+	//	exposure_ratio - current exposure ratio of the camera
+	//	generation - current generation
+	//	fitness - set to the cached fitness on a hit
+	// Output: true if a valid entry was found
+	bool lookup(uint64_t key, double exposure_ratio, int generation, double & fitness) {
+		std::unique_lock<std::mutex> lock(this->mutex_);
+		auto found = this->entries_.find(key);
+		if (found != this->entries_.end() && found->second.exposure_ratio == exposure_ratio
+			&& generation - found->second.generation < this->ttl_) {
+			fitness = found->second.fitness;
+			this->hits_++;
+			this->total_hits_++;
+			return true;
+		}
+		this->misses_++;
+		return false;
+	}
+
+	// Record a measured fitness
+	// Input:
+	//	key - hash of the genomes (see hashGenome())
+	//	fitness - fitness as recorded for the individual
+	//	exposure_ratio - current exposure ratio of the camera (the same source as given to lookup())
+	//	generation - current generation
+	void store(uint64_t key, double fitness, double exposure_ratio, int generation) {
+		std::unique_lock<std::mutex> lock(this->mutex_);
+		Entry entry = { fitness, exposure_ratio, generation };
+		this->entries_[key] = entry;
+	}
+
+	// End the generation, returning its counters and dropping expired entries (or all if the cache grew past its bound)
+	// Input:
+	//	generation - generation that just ended
+	//	hits - set to number of hits during the generation (hardware evaluations skipped)
+	//	misses - set to number of misses during the generation
+	void endGeneration(int generation, int & hits, int & misses) {
+		std::unique_lock<std::mutex> lock(this->mutex_);
+		hits = this->hits_;
+		misses = this->misses_;
+		this->hits_ = this->misses_ = 0;
+		// Entries expiring after this generation can never hit again
+		for (auto it = this->entries_.begin(); it != this->entries_.end();) {
+			if (generation + 1 - it->second.generation >= this->ttl_) {
+				it = this->entries_.erase(it);
+			}
+			else {
+				++it;
+			}
+		}
+		if (this->entries_.size() > this->max_entries_) {
+			this->entries_.clear();
+		}
+	}
+
+	// Total hardware evaluations (SLM write & camera frame) saved over the run
+	const long long getSavedFrames() const {
+		return this->total_hits_;
+	}
+};
+
+#endif
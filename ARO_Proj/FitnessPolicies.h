@@ -0,0 +1,567 @@
+////////////////////
+// FitnessPolicies.h - fitness functions of a camera image, each a policy compiled per pixel type, selected per run with FitnessFunction
+////////////////////
+
+#ifndef FITNESS_POLICIES_H_
+#define FITNESS_POLICIES_H_
+
+#include <vector>
+#include <string>
+#include <cmath>	// sqrt(), ceil(), floor() & exp()
+#include <algorithm>	// std::min, std::max & std::sort
+#include <utility>		// std::pair
+#include <cstdint>
+
+#include "PixelTraits.h"	// PixelEncoding, PixelTraits<P>::load() & PixelSum::sumRow()
+
+// Types of fitness function (value of the "fitnessFunction" setting)
+enum class FitnessType {
+	MeanIntensity = 0,		// Mean intensity within the target
+	GaussianSpot = 1,		// Gaussian weighted intensity around the target center (sigma of half the target radius)
+	EnhancementFactor = 2,	// Mean intensity within the target over the mean of the background (image outside twice the target)
+	AnnulusContrast = 3,	// Mean intensity within the target over the mean of the annulus from one to two target radii
+	MultiTarget = 4			// Mean intensities of several spots combined by a TargetAggregator
+};
+
+// How MultiTarget combines the spot means m_i with weights w_i (normalized so the mean weight is 1)
+enum class TargetAggregator {
+	Sum = 0,		// Weighted mean, sum of w_i * m_i over the number of spots
+	Min = 1,		// Weakest spot relative to its weight, min of m_i / w_i
+	Uniformity = 2	// Weighted mean times the uniformity 1 - (max - min) / (max + min) of m_i / w_i
+};
+
+// Target in the camera image, an ellipse centered at (width/2 + offsetX, height/2 + offsetY)
+// with semi-axes radius (x) and radius * aspect (y), a centered circle by default
+struct TargetShape {
+	int radius;
+	double offsetX;
+	double offsetY;
+	double aspect;
+
+	TargetShape(int radius = 0, double offsetX = 0, double offsetY = 0, double aspect = 1) {
+		this->radius = radius;
+		this->offsetX = offsetX;
+		this->offsetY = offsetY;
+		this->aspect = aspect;
+	}
+};
+
+// A spot of a multiple target fitness, weight is its share of the total intensity relative to the other spots
+struct TargetSpot {
+	TargetShape shape;
+	double weight;
+
+	TargetSpot(const TargetShape & shape = TargetShape(), double weight = 1) : shape(shape) {
+		this->weight = weight;
+	}
+};
+
+// The target(s) of a fitness function
+//	shape - target of the single target policies
+//	spots, aggregator - targets of MultiTarget and how they are combined
+struct FitnessTargets {
+	TargetShape shape;
+	std::vector<TargetSpot> spots;
+	TargetAggregator aggregator;
+
+	FitnessTargets(const TargetShape & shape = TargetShape()) : shape(shape) {
+		this->aggregator = TargetAggregator::Sum;
+	}
+};
+
+// Set of pixels of an image as [x0, x1) spans of rows (a row may have two spans), computed once then summed per image
+class SpanMask {
+public:
+	std::vector<int> rows, x0, x1;
+	long long count;	// Number of pixels
+
+	SpanMask() {
+		this->count = 0;
+	}
+
+	// Set the mask to the pixels of a ring of the target, those with inner < rho <= outer
+	// where rho is the distance from the target center relative to the semi-axes (1 on the target edge)
+	// Input:
+	//	width, height - image size, the mask is clipped to it
+	//	shape - the target
+	//	inner - rho of the hole, negative for none
+	//	outer - rho of the outer edge (large values cover the whole image)
+	void setRing(int width, int height, const TargetShape & shape, double inner, double outer) {
+		this->rows.clear();
+		this->x0.clear();
+		this->x1.clear();
+		this->count = 0;
+		const double cx = width / 2 + shape.offsetX;
+		const double cy = height / 2 + shape.offsetY;
+		const double ax = shape.radius, ay = shape.radius * shape.aspect;
+		if (ax <= 0 || ay <= 0) {
+			// A zero size target is its center pixel
+			const int x = int(floor(cx + 0.5)), y = int(floor(cy + 0.5));
+			if (inner < 0 && x >= 0 && x < width && y >= 0 && y < height) {
+				this->addSpan(y, x, x + 1);
+			}
+			return;
+		}
+		for (int y = 0; y < height; y++) {
+			const double dy = y - cy;
+			// Half width of an ellipse of relative size rho at this row, negative if the row misses it
+			// (for a centered circle the sqrt is exact on whole pixels, the small margin keeps edge pixels on floating point rounding)
+			auto halfWidth = [&](double rho) {
+				const double h2 = rho * rho * ax * ax - dy * dy * (ax * ax) / (ay * ay);
+				return (h2 < 0) ? -1.0 : sqrt(h2) + 1e-9;
+			};
+			const double outerHalf = halfWidth(outer);
+			if (outerHalf < 0) {
+				continue;
+			}
+			int spanStart = (int)(std::max)(0.0, ceil(cx - outerHalf));
+			int spanEnd = (int)(std::min)(double(width), floor(cx + outerHalf) + 1);
+			const double innerHalf = (inner >= 0) ? halfWidth(inner) : -1.0;
+			if (innerHalf >= 0) {
+				// Hole of this row, [holeStart, holeEnd)
+				const int holeStart = (int)(std::max)(double(spanStart), ceil(cx - innerHalf));
+				const int holeEnd = (int)(std::min)(double(spanEnd), floor(cx + innerHalf) + 1);
+				if (holeEnd > holeStart) {
+					this->addSpan(y, spanStart, holeStart);
+					spanStart = holeEnd;
+				}
+			}
+			this->addSpan(y, spanStart, spanEnd);
+		}
+	}
+
+	// Sum of the pixels in the mask
+	// Input: image - pixels of type P, rowBytes - bytes per row
+	template <class P>
+	uint64_t sum(const unsigned char * image, size_t rowBytes) const {
+		uint64_t total = 0;
+		for (int i = 0; i < this->rows.size(); i++) {
+			total += PixelSum::sumRow<P>(image + rowBytes * this->rows[i], this->x0[i], this->x1[i]);
+		}
+		return total;
+	}
+
+private:
+	void addSpan(int y, int start, int end) {
+		if (end > start) {
+			this->rows.push_back(y);
+			this->x0.push_back(start);
+			this->x1.push_back(end);
+			this->count += end - start;
+		}
+	}
+};
+
+// Policies, each has
+//	reset(width, height, targets) - precompute what is needed for an image size and target(s)
+//	template <class P> double evaluate(image, rowBytes, targetMean, spotMeans) const - fitness of an image of P pixels,
+//		targetMean set to the mean intensity of the (brightest) target on the 8 bit scale (used to shorten the exposure)
+//		spotMeans, if not NULL, set to the mean of each target (spotCount() values)
+//	spotCount() - number of targets
+//	scales_with_exposure - true if the fitness is an intensity (recorded relative to the initial exposure), false for ratios
+namespace FitnessPolicy {
+	// Mean of the target mask on the 8 bit scale, 0 if the mask is empty
+	template <class P>
+	inline double maskMean(const SpanMask & mask, const unsigned char * image, size_t rowBytes) {
+		if (mask.count == 0) {
+			return 0;
+		}
+		return double(mask.sum<P>(image, rowBytes)) * (255.0 / PixelTraits<P>::max_value) / double(mask.count);
+	}
+
+	// Record the mean of a target if spot values are wanted
+	inline void reportSpot(double * spotMean, double mean) {
+		if (spotMean != NULL) {
+			*spotMean = mean;
+		}
+	}
+
+	// Ratio of two means, guarded so a dark background doesn't divide by zero (one count on the 8 bit scale at least)
+	inline double meanRatio(double numerator, double denominator) {
+		return numerator / (std::max)(denominator, 1.0);
+	}
+
+	struct MeanIntensity {
+		static const bool scales_with_exposure = true;
+		SpanMask target;
+
+		void reset(int width, int height, const FitnessTargets & targets) {
+			const TargetShape & shape = targets.shape;
+			this->target.setRing(width, height, shape, -1, 1);
+		}
+
+		template <class P>
+		double evaluate(const unsigned char * image, size_t rowBytes, double & targetMean, double * spotMeans) const {
+			targetMean = maskMean<P>(this->target, image, rowBytes);
+			reportSpot(spotMeans, targetMean);
+			return targetMean;
+		}
+
+		const int spotCount() const {
+			return 1;
+		}
+	};
+
+	struct GaussianSpot {
+		static const bool scales_with_exposure = true;
+		SpanMask window;			// Pixels within three sigma
+		std::vector<float> weights;	// Weight of each pixel of window, span after span
+		double weightSum;
+
+		void reset(int width, int height, const FitnessTargets & targets) {
+			const TargetShape & shape = targets.shape;
+			// sigma is half the target semi-axes, so rho = 2 * (distance in sigma)
+			this->window.setRing(width, height, shape, -1, 1.5);
+			this->weights.clear();
+			this->weightSum = 0;
+			const double cx = width / 2 + shape.offsetX;
+			const double cy = height / 2 + shape.offsetY;
+			const double ax = shape.radius, ay = shape.radius * shape.aspect;
+			if (ax <= 0 || ay <= 0) {
+				// Zero size target, window is the center pixel
+				this->weights.assign(size_t(this->window.count), 1.0f);
+				this->weightSum = double(this->window.count);
+				return;
+			}
+			for (int i = 0; i < this->window.rows.size(); i++) {
+				const double dy = (this->window.rows[i] - cy) / ay;
+				for (int x = this->window.x0[i]; x < this->window.x1[i]; x++) {
+					const double dx = (x - cx) / ax;
+					const float weight = float(exp(-2.0 * (dx * dx + dy * dy)));
+					this->weights.push_back(weight);
+					this->weightSum += weight;
+				}
+			}
+		}
+
+		template <class P>
+		double evaluate(const unsigned char * image, size_t rowBytes, double & targetMean, double * spotMeans) const {
+			if (this->weightSum <= 0) {
+				targetMean = 0;
+				reportSpot(spotMeans, targetMean);
+				return 0;
+			}
+			double total = 0;
+			const float * weight = this->weights.data();
+			for (int i = 0; i < this->window.rows.size(); i++) {
+				const unsigned char * row = image + rowBytes * this->window.rows[i];
+				const int x0 = this->window.x0[i], x1 = this->window.x1[i];
+				// Float multiply-add over the span (converts and multiplies in vector lanes), spans totalled in double
+				float spanTotal = 0;
+				for (int x = x0; x < x1; x++) {
+					spanTotal += weight[x - x0] * float(PixelTraits<P>::load(row, x));
+				}
+				total += spanTotal;
+				weight += x1 - x0;
+			}
+			targetMean = total * (255.0 / PixelTraits<P>::max_value) / this->weightSum;
+			reportSpot(spotMeans, targetMean);
+			return targetMean;
+		}
+
+		const int spotCount() const {
+			return 1;
+		}
+	};
+
+	struct EnhancementFactor {
+		static const bool scales_with_exposure = false;
+		SpanMask target, background;
+
+		void reset(int width, int height, const FitnessTargets & targets) {
+			const TargetShape & shape = targets.shape;
+			this->target.setRing(width, height, shape, -1, 1);
+			this->background.setRing(width, height, shape, 2, 1e9);
+		}
+
+		template <class P>
+		double evaluate(const unsigned char * image, size_t rowBytes, double & targetMean, double * spotMeans) const {
+			targetMean = maskMean<P>(this->target, image, rowBytes);
+			reportSpot(spotMeans, targetMean);
+			return meanRatio(targetMean, maskMean<P>(this->background, image, rowBytes));
+		}
+
+		const int spotCount() const {
+			return 1;
+		}
+	};
+
+	struct AnnulusContrast {
+		static const bool scales_with_exposure = false;
+		SpanMask target, annulus;
+
+		void reset(int width, int height, const FitnessTargets & targets) {
+			const TargetShape & shape = targets.shape;
+			this->target.setRing(width, height, shape, -1, 1);
+			this->annulus.setRing(width, height, shape, 1, 2);
+		}
+
+		template <class P>
+		double evaluate(const unsigned char * image, size_t rowBytes, double & targetMean, double * spotMeans) const {
+			targetMean = maskMean<P>(this->target, image, rowBytes);
+			reportSpot(spotMeans, targetMean);
+			return meanRatio(targetMean, maskMean<P>(this->annulus, image, rowBytes));
+		}
+
+		const int spotCount() const {
+			return 1;
+		}
+	};
+
+	struct MultiTarget {
+		static const bool scales_with_exposure = true;
+		// Spans of every spot merged and ordered by row, so a frame is read once from top to bottom
+		std::vector<int> rows, x0, x1, spot;
+		std::vector<long long> counts;	// Pixels of each spot
+		std::vector<double> weights;	// Normalized weight of each spot (mean of 1)
+		TargetAggregator aggregator;
+
+		void reset(int width, int height, const FitnessTargets & targets) {
+			this->rows.clear();
+			this->x0.clear();
+			this->x1.clear();
+			this->spot.clear();
+			this->counts.clear();
+			this->weights.clear();
+			this->aggregator = targets.aggregator;
+
+			// Order the spans of all spots by row (then by start)
+			std::vector<std::pair<std::pair<int, int>, std::pair<int, int>>> spans; // ((row, x0), (x1, spot))
+			double weightTotal = 0;
+			for (int i = 0; i < targets.spots.size(); i++) {
+				SpanMask mask;
+				mask.setRing(width, height, targets.spots[i].shape, -1, 1);
+				for (int k = 0; k < mask.rows.size(); k++) {
+					spans.push_back(std::make_pair(std::make_pair(mask.rows[k], mask.x0[k]), std::make_pair(mask.x1[k], i)));
+				}
+				this->counts.push_back(mask.count);
+				this->weights.push_back(targets.spots[i].weight);
+				weightTotal += targets.spots[i].weight;
+			}
+			std::sort(spans.begin(), spans.end());
+			for (int k = 0; k < spans.size(); k++) {
+				this->rows.push_back(spans[k].first.first);
+				this->x0.push_back(spans[k].first.second);
+				this->x1.push_back(spans[k].second.first);
+				this->spot.push_back(spans[k].second.second);
+			}
+			for (int i = 0; i < this->weights.size(); i++) {
+				this->weights[i] = (weightTotal > 0) ? this->weights[i] * this->weights.size() / weightTotal : 1;
+			}
+		}
+
+		template <class P>
+		double evaluate(const unsigned char * image, size_t rowBytes, double & targetMean, double * spotMeans) const {
+			const int spots = this->spotCount();
+			if (spots == 0) {
+				targetMean = 0;
+				return 0;
+			}
+			std::vector<uint64_t> sums(spots, 0);
+			for (int k = 0; k < this->rows.size(); k++) {
+				sums[this->spot[k]] += PixelSum::sumRow<P>(image + rowBytes * this->rows[k], this->x0[k], this->x1[k]);
+			}
+
+			// Means, and the means relative to the weights
+			double weightedTotal = 0, relMin = 0, relMax = 0;
+			targetMean = 0;
+			for (int i = 0; i < spots; i++) {
+				const double mean = (this->counts[i] > 0) ? double(sums[i]) * (255.0 / PixelTraits<P>::max_value) / double(this->counts[i]) : 0;
+				const double rel = (this->weights[i] > 0) ? mean / this->weights[i] : mean;
+				reportSpot(spotMeans == NULL ? NULL : spotMeans + i, mean);
+				targetMean = (std::max)(targetMean, mean);
+				weightedTotal += this->weights[i] * mean;
+				relMin = (i == 0) ? rel : (std::min)(relMin, rel);
+				relMax = (i == 0) ? rel : (std::max)(relMax, rel);
+			}
+			const double weightedMean = weightedTotal / spots;
+			switch (this->aggregator) {
+			case TargetAggregator::Min:
+				return relMin;
+			case TargetAggregator::Uniformity:
+				return (relMax + relMin > 0) ? weightedMean * (1 - (relMax - relMin) / (relMax + relMin)) : 0;
+			default:
+				return weightedMean;
+			}
+		}
+
+		const int spotCount() const {
+			return int(this->counts.size());
+		}
+	};
+}
+
+// A policy prepared for an image size, dispatching once per image on the pixel encoding
+template <class Policy>
+class FitnessKernel {
+private:
+	Policy policy_;
+	int width_, height_;
+
+public:
+	FitnessKernel() {
+		this->width_ = this->height_ = 0;
+	}
+
+	void reset(int width, int height, const FitnessTargets & targets) {
+		this->width_ = width;
+		this->height_ = height;
+		this->policy_.reset(width, height, targets);
+	}
+
+	// Number of targets of the policy
+	const int spotCount() const {
+		return this->policy_.spotCount();
+	}
+
+	// True if reset() was for this image size
+	const bool matches(int width, int height) const {
+		return width == this->width_ && height == this->height_;
+	}
+
+	double evaluate(const void * image, PixelEncoding encoding, double & targetMean, double * spotMeans) const {
+		const unsigned char * data = static_cast<const unsigned char*>(image);
+		switch (encoding) {
+		case PixelEncoding::Mono16:
+			return this->policy_.template evaluate<uint16_t>(data, PixelTraits<uint16_t>::rowBytes(this->width_), targetMean, spotMeans);
+		case PixelEncoding::Mono12p:
+			return this->policy_.template evaluate<Mono12Packed>(data, PixelTraits<Mono12Packed>::rowBytes(this->width_), targetMean, spotMeans);
+		default:
+			return this->policy_.template evaluate<uint8_t>(data, PixelTraits<uint8_t>::rowBytes(this->width_), targetMean, spotMeans);
+		}
+	}
+};
+
+// The fitness function of a run, reset once for the fitness type, image size and target (prepareSoftwareHardware())
+// evaluate() is const and can be called from several threads at once.
+class FitnessFunction {
+private:
+	FitnessType type_;
+	FitnessTargets targets_;
+	FitnessKernel<FitnessPolicy::MeanIntensity> meanIntensity_;
+	FitnessKernel<FitnessPolicy::GaussianSpot> gaussianSpot_;
+	FitnessKernel<FitnessPolicy::EnhancementFactor> enhancementFactor_;
+	FitnessKernel<FitnessPolicy::AnnulusContrast> annulusContrast_;
+	FitnessKernel<FitnessPolicy::MultiTarget> multiTarget_;
+
+public:
+	FitnessFunction() {
+		this->type_ = FitnessType::MeanIntensity;
+	}
+
+	// Prepare the selected policy
+	// Input:
+	//	type - fitness function to use
+	//	width, height - camera image size in pixels
+	//	targets - target(s) in the image
+	void reset(FitnessType type, int width, int height, const FitnessTargets & targets) {
+		this->type_ = type;
+		this->targets_ = targets;
+		switch (type) {
+		case FitnessType::GaussianSpot:
+			this->gaussianSpot_.reset(width, height, targets);
+			break;
+		case FitnessType::EnhancementFactor:
+			this->enhancementFactor_.reset(width, height, targets);
+			break;
+		case FitnessType::AnnulusContrast:
+			this->annulusContrast_.reset(width, height, targets);
+			break;
+		case FitnessType::MultiTarget:
+			this->multiTarget_.reset(width, height, targets);
+			break;
+		default:
+			this->type_ = FitnessType::MeanIntensity;
+			this->meanIntensity_.reset(width, height, targets);
+			break;
+		}
+	}
+
+	// Fitness of a camera image
+	// Input:
+	//	image - pixel data (see ImageController::getPixelData())
+	//	encoding - encoding of the pixels
+	//	width, height - size of image, if they differ from the size given to reset() the policy is prepared for this image
+	//	targetMean - set to the mean intensity of the (brightest) target on the 8 bit scale (compare with maxFitnessValue to shorten exposure)
+	//	spotMeans - if not NULL, set to the mean intensity of each target (getSpotCount() values)
+	// Output: the fitness (intensities on the 8 bit scale whatever the encoding)
+	double evaluate(const void * image, PixelEncoding encoding, int width, int height, double & targetMean, double * spotMeans = NULL) const {
+		switch (this->type_) {
+		case FitnessType::GaussianSpot:
+			return evaluateWith(this->gaussianSpot_, image, encoding, width, height, targetMean, spotMeans);
+		case FitnessType::EnhancementFactor:
+			return evaluateWith(this->enhancementFactor_, image, encoding, width, height, targetMean, spotMeans);
+		case FitnessType::AnnulusContrast:
+			return evaluateWith(this->annulusContrast_, image, encoding, width, height, targetMean, spotMeans);
+		case FitnessType::MultiTarget:
+			return evaluateWith(this->multiTarget_, image, encoding, width, height, targetMean, spotMeans);
+		default:
+			return evaluateWith(this->meanIntensity_, image, encoding, width, height, targetMean, spotMeans);
+		}
+	}
+
+	// Number of targets (spot values given by evaluate())
+	const int getSpotCount() const {
+		return (this->type_ == FitnessType::MultiTarget) ? this->multiTarget_.spotCount() : 1;
+	}
+
+	// Scale to record a fitness at: the exposure ratio for intensities (relative to the initial exposure), 1 for ratios
+	const double fitnessScale(double exposureRatio) const {
+		switch (this->type_) {
+		case FitnessType::GaussianSpot:
+			return FitnessPolicy::GaussianSpot::scales_with_exposure ? exposureRatio : 1;
+		case FitnessType::EnhancementFactor:
+			return FitnessPolicy::EnhancementFactor::scales_with_exposure ? exposureRatio : 1;
+		case FitnessType::AnnulusContrast:
+			return FitnessPolicy::AnnulusContrast::scales_with_exposure ? exposureRatio : 1;
+		case FitnessType::MultiTarget:
+			return FitnessPolicy::MultiTarget::scales_with_exposure ? exposureRatio : 1;
+		default:
+			return FitnessPolicy::MeanIntensity::scales_with_exposure ? exposureRatio : 1;
+		}
+	}
+
+	const FitnessType getType() const {
+		return this->type_;
+	}
+
+	const FitnessTargets & getTargets() const {
+		return this->targets_;
+	}
+
+	// Name of the fitness function for the parameters file
+	const std::string getName() const {
+		switch (this->type_) {
+		case FitnessType::GaussianSpot:
+			return "Gaussian Spot";
+		case FitnessType::EnhancementFactor:
+			return "Enhancement Factor";
+		case FitnessType::AnnulusContrast:
+			return "Annulus Contrast";
+		case FitnessType::MultiTarget:
+			switch (this->targets_.aggregator) {
+			case TargetAggregator::Min:
+				return "Multiple Target (Min)";
+			case TargetAggregator::Uniformity:
+				return "Multiple Target (Uniformity)";
+			default:
+				return "Multiple Target (Sum)";
+			}
+		default:
+			return "Mean Intensity";
+		}
+	}
+
+private:
+	template <class Policy>
+	double evaluateWith(const FitnessKernel<Policy> & kernel, const void * image, PixelEncoding encoding, int width, int height, double & targetMean, double * spotMeans) const {
+		if (!kernel.matches(width, height)) {
+			FitnessKernel<Policy> resized;
+			resized.reset(width, height, this->targets_);
+			return resized.evaluate(image, encoding, targetMean, spotMeans);
+		}
+		return kernel.evaluate(image, encoding, targetMean, spotMeans);
+	}
+};
+
+#endif
@@ -0,0 +1,136 @@
+////////////////////
+// FrameBufferPool.h - reusable fixed size buffers for camera frames, handed out as RAII handles
+////////////////////
+
+#ifndef FRAME_BUFFER_POOL_H_
+#define FRAME_BUFFER_POOL_H_
+
+#include <memory>	// std::shared_ptr & enable_shared_from_this
+#include <mutex>	// Guarding the free list
+#include <vector>
+
+class FrameBufferPool;
+
+// Handle to a buffer of a FrameBufferPool, the buffer goes back to the pool when the handle is destroyed or reset
+// Move only, the pool is kept alive by the handle so a frame may outlive the camera controller that made it
+class PooledBuffer {
+private:
+	std::shared_ptr<FrameBufferPool> pool_;
+	unsigned char * data_;
+
+public:
+	// Empty handle
+	PooledBuffer() {
+		this->data_ = NULL;
+	}
+
+	// Handle to data, to be returned to pool (used by FrameBufferPool::acquire())
+	PooledBuffer(const std::shared_ptr<FrameBufferPool> & pool, unsigned char * data) : pool_(pool) {
+		this->data_ = data;
+	}
+
+	PooledBuffer(PooledBuffer && other) : pool_(std::move(other.pool_)) {
+		this->data_ = other.data_;
+		other.data_ = NULL;
+	}
+
+	PooledBuffer& operator=(PooledBuffer && other) {
+		if (this != &other) {
+			this->reset();
+			this->pool_ = std::move(other.pool_);
+			this->data_ = other.data_;
+			other.data_ = NULL;
+		}
+		return *this;
+	}
+
+	PooledBuffer(const PooledBuffer & other) = delete;
+	PooledBuffer& operator=(const PooledBuffer & other) = delete;
+
+	~PooledBuffer() {
+		this->reset();
+	}
+
+	// Return the buffer to its pool, leaving the handle empty
+	inline void reset();
+
+	// The buffer, NULL if empty
+	unsigned char * get() const {
+		return this->data_;
+	}
+};
+
+// Pool of buffers of bufferSize bytes, grows as needed and keeps returned buffers for reuse
+// Thread safe, frames may be released from the threads processing them.
+// Create with std::make_shared (handles refer back to the pool through shared_from_this())
+class FrameBufferPool : public std::enable_shared_from_this<FrameBufferPool> {
+private:
+	size_t bufferSize_;
+	std::mutex mutex_;
+	std::vector<unsigned char*> free_;
+	int allocated_;
+
+public:
+	// Constructor
+	// Input: bufferSize - bytes in each buffer
+	FrameBufferPool(size_t bufferSize) {
+		this->bufferSize_ = bufferSize;
+		this->allocated_ = 0;
+	}
+
+	// Destructor - runs once every handle is gone, so all buffers are in the free list
+	~FrameBufferPool() {
+		for (int i = 0; i < this->free_.size(); i++) {
+			delete[] this->free_[i];
+		}
+	}
+
+	FrameBufferPool(const FrameBufferPool & other) = delete;
+	FrameBufferPool& operator=(const FrameBufferPool & other) = delete;
+
+	// Get a buffer, reusing a returned one if available (contents are not cleared)
+	PooledBuffer acquire() {
+		unsigned char * data = NULL;
+		{
+			std::unique_lock<std::mutex> lock(this->mutex_);
+			if (!this->free_.empty()) {
+				data = this->free_.back();
+				this->free_.pop_back();
+			}
+			else {
+				this->allocated_++;
+			}
+		}
+		if (data == NULL) {
+			data = new unsigned char[this->bufferSize_];
+		}
+		return PooledBuffer(this->shared_from_this(), data);
+	}
+
+	// Take back a buffer (called by PooledBuffer)
+	void release(unsigned char * data) {
+		std::unique_lock<std::mutex> lock(this->mutex_);
+		this->free_.push_back(data);
+	}
+
+	// Bytes in each buffer
+	const size_t getBufferSize() const {
+		return this->bufferSize_;
+	}
+
+	// Number of buffers the pool has allocated (in use and free)
+	const int getAllocatedCount() {
+		std::unique_lock<std::mutex> lock(this->mutex_);
+		return this->allocated_;
+	}
+};
+
+void PooledBuffer::reset() {
+	if (this->data_ != NULL) {
+		this->pool_->release(this->data_);
+		this->data_ = NULL;
+	}
+	this->pool_.reset();
+}
+
+#endif
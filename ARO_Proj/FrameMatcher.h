@@ -0,0 +1,131 @@
+////////////////////
+// FrameMatcher.h - pairs SLM patterns with the first camera frame fully exposed after the pattern settled
+////////////////////
+
+#ifndef FRAME_MATCHER_H_
+#define FRAME_MATCHER_H_
+
+#include <chrono>	// SteadyClock
+#include <deque>	// pending_
+
+// Host clock in nanoseconds, the default clock of FrameMatcher (the camera controllers convert frame times to it)
+// A clock for FrameMatcher only needs a long long now() method, so a simulated clock can be used for testing
+struct SteadyClock {
+	long long now() const {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+};
+
+// Timing of a camera frame, in the timebase of the matcher's clock
+struct FrameStamp {
+	long long frame_id;			// Frame counter of the camera (gaps mean frames were dropped)
+	long long exposure_start;	// Start of exposure (ns)
+	long long exposure;			// Exposure duration (ns)
+};
+
+// Every SLM write is given a sequence number and a settle deadline (write time + settle time).
+// A frame is matched to the newest written pattern whose deadline is no later than the frame's exposure start,
+// as long as no newer pattern was written before the exposure ended (the frame would mix two patterns).
+// Frames exposed too early are discarded, so the camera can run near its maximum frame rate without seeing unsettled patterns.
+// Older patterns passed over by a match are counted as missed (never captured on their own).
+// Clock - class with a long long now() method in nanoseconds (SteadyClock for the hardware)
+template <class Clock = SteadyClock>
+class FrameMatcher {
+private:
+	struct Pattern {
+		long long seq;		 // Sequence number
+		long long written;	 // Time the write finished
+		long long deadline;	 // Time the pattern is settled
+	};
+	Clock clock_;
+	// Time after a write before the SLM shows the pattern (ns)
+	long long settle_;
+	// Patterns written and not yet matched, oldest first
+	std::deque<Pattern> pending_;
+	long long next_seq_;
+	// Frame id of the last frame offered (-1 before the first)
+	long long last_frame_id_;
+	// Counters over the run
+	long long matched_, discarded_, missed_, dropped_;
+
+public:
+	// Constructor
+	// Input:
+	//	settle - time after a write finishes before the pattern is settled on the SLM (ns)
+	//	clock - clock stamping the writes (same timebase as the frame stamps)
+	FrameMatcher(long long settle, const Clock & clock = Clock()) : clock_(clock) {
+		this->settle_ = settle;
+		this->next_seq_ = 0;
+		this->last_frame_id_ = -1;
+		this->matched_ = this->discarded_ = this->missed_ = this->dropped_ = 0;
+	}
+
+	// Record that a pattern has just been written to the SLM(s)
+	// Output: sequence number of the pattern
+	long long patternWritten() {
+		const long long written = this->clock_.now();
+		Pattern pattern = { this->next_seq_++, written, written + this->settle_ };
+		this->pending_.push_back(pattern);
+		return pattern.seq;
+	}
+
+	// Offer a camera frame
+	// Input: frame - timing of the frame
+	// Output: sequence number of the pattern the frame shows, -1 if the frame is to be discarded
+	long long offerFrame(const FrameStamp & frame) {
+		if (this->last_frame_id_ >= 0 && frame.frame_id > this->last_frame_id_ + 1) {
+			this->dropped_ += frame.frame_id - this->last_frame_id_ - 1;
+		}
+		this->last_frame_id_ = frame.frame_id;
+
+		// Newest pattern settled before the exposure started
+		int match = -1;
+		for (int i = 0; i < int(this->pending_.size()) && this->pending_[i].deadline <= frame.exposure_start; i++) {
+			match = i;
+		}
+		// The next pattern must not have been written before the exposure ended
+		const bool overlapped = (match + 1 < int(this->pending_.size())) && this->pending_[match + 1].written < frame.exposure_start + frame.exposure;
+		if (match < 0 || overlapped) {
+			this->discarded_++;
+			return -1;
+		}
+		const long long seq = this->pending_[match].seq;
+		this->missed_ += match;
+		this->pending_.erase(this->pending_.begin(), this->pending_.begin() + match + 1);
+		this->matched_++;
+		return seq;
+	}
+
+	// Forget the patterns not matched yet (such as after an acquisition error)
+	void clearPending() {
+		this->missed_ += this->pending_.size();
+		this->pending_.clear();
+	}
+
+	// Time after a write before the pattern is settled (ns)
+	const long long getSettleTime() const {
+		return this->settle_;
+	}
+
+	// Number of frames matched to a pattern
+	const long long getMatchedCount() const {
+		return this->matched_;
+	}
+
+	// Number of frames discarded (exposed before a pattern settled or across a pattern change)
+	const long long getDiscardedCount() const {
+		return this->discarded_;
+	}
+
+	// Number of patterns passed over without a frame of their own
+	const long long getMissedCount() const {
+		return this->missed_;
+	}
+
+	// Number of frames the camera dropped (gaps in the frame ids)
+	const long long getDroppedCount() const {
+		return this->dropped_;
+	}
+};
+
+#endif
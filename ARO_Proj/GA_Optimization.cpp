@@ -5,8 +5,10 @@
 
 #include "stdafx.h"				// Required in source
 #include "GA_Optimization.h"	// Header file
+#include "SLMFrameBankCheck.h"	// checkSLMFrameBank() in debug build
 
-bool GA_Optimization::runOptimization() {
+template <class T>
+bool GA_Optimization<T>::runOptimization() {
 	Utility::printLine("INFO: Starting " + this->algorithm_name_ + " Optimization!");
 
 
@@ -21,7 +23,8 @@ bool GA_Optimization::runOptimization() {
 		this->gaPoolThreadCount = _tstoi(tempBuff);
 
 		// If the indThreadCount and gaPoolThreadCount are less than what the hardware supports, than we don't need the additional threads to be created in the pool
-		const int threadPool_size = std::min(int(std::thread::hardware_concurrency()), std::max(this->indThreadCount, this->gaPoolThreadCount));
+		// At least two threads, the scaling stage of the evaluation pipeline occupies one while the others process the images (see evaluatePipelined())
+		const int threadPool_size = std::max(2, std::min(int(std::thread::hardware_concurrency()), std::max(this->indThreadCount, this->gaPoolThreadCount)));
 		this->myThreadPool_ = new threadPool(threadPool_size);
 
 		Utility::printLine("INFO: Using up to " + std::to_string(threadPool_size) + " threads");
@@ -42,34 +45,40 @@ bool GA_Optimization::runOptimization() {
 		return false;
 	}
 
+	// Start each run with an empty cache
+	this->fitnessCache.reset(this->useFitnessCache ? this->fitnessCacheTTL : 0);
+	int cacheHits, cacheMisses;
+
 	// Doubles to track time elapsed during optimization
 	double opt_start, opt_end, generation_start, generation_end, individuals_start, individuals_end, nextGen_start, nextGen_end;
 	try {	// Begin camera exception handling while optimization loop is going
-		// Lambda function to access this instance of Optimization to perform runIndividual for group of individuals (fewer threads)
-		// Input: threadID - this thread
-		//		  numThreads - total number of threads being run
-		// Captures: this - pointer to current GA_Optimization instance
-		auto evaluateSubGroup = [this](const int threadID){
-			int groupSize = (this->populationSize / this->indThreadCount);
-			int remainder = this->populationSize - groupSize*this->indThreadCount;
-			int start_index = threadID*groupSize;
-
-			if (remainder != 0) {
-				if (threadID < remainder) {
-					groupSize++;
-					start_index += threadID;
-				}
-				else {
-					start_index += remainder;
-				}
+		// Frames the pipeline scales genomes into ahead of the hardware (or the bank holding a generation in SLM RAM)
+		this->pipelineFrames.clear();
+		if (this->useSLMFrameBank) {
+#ifdef _DEBUG // In debug build, check the bank against a stand-in SDK first
+			if (checkSLMFrameBank()) {
+				Utility::printLine("INFO: SLM frame bank check passed", true);
 			}
-
-			for (int id = start_index; id < start_index + groupSize && id < this->populationSize; id++) {
-				if (this->skipEliteReevaluation == false || (this->skipEliteReevaluation == true && this->population[0]->getFitness(id) == -1)) {
-					this->runIndividual(id);
+#endif
+			this->frameBank = new SLMFrameBank<Blink_SDK>(this->sc->blink_sdk, this->populationSize);
+			for (int i = 0; i < this->popCount; i++) {
+				const int boardID = this->optBoards[i]->board_id;
+				this->frameBank->addBoard(boardID, this->optBoards[i]->GetArea(), this->sc->getBoardHeight(boardID - 1));
+			}
+		}
+		else if (this->multithreadEnable) {
+			for (int slot = 0; slot < this->pipelineDepth; slot++) {
+				for (int i = 0; i < this->popCount; i++) {
+					unsigned char * frame = new unsigned char[this->optBoards[i]->GetArea()];
+					this->scalers[i]->ZeroOutputImage(frame);
+					this->pipelineFrames.push_back(frame);
 				}
 			}
-		};
+		}
+
+		this->startFrameMatching();
+		this->framesResident = false;
+		this->residentFrameGenerations = 0;
 
 		Utility::printLine("INFO: Beginning optimization loop");
 		this->timestamp = new TimeStampGenerator();		// Starting time stamp to track elapsed time
@@ -80,12 +89,13 @@ bool GA_Optimization::runOptimization() {
 			individuals_start = generation_start;
 			// Run each individual, giving them all fitness values as a result of their genome
 
-			if (this->multithreadEnable == true) {
-				// Parallel
-				for (int indID = 0; indID < this->indThreadCount; indID++) {
-					this->myThreadPool_->pushJob(std::bind(evaluateSubGroup, indID));
-				}
-				this->myThreadPool_->wait();
+			if (this->frameBank != NULL) {
+				// Whole generation uploaded to the SLMs, each individual only selects its frame
+				this->evaluateBatched();
+			}
+			else if (this->multithreadEnable == true) {
+				// Pipelined, scaling and image processing overlap the hardware
+				this->evaluatePipelined();
 			}
 			else {
 				for (int indID = 0; indID < this->populationSize; indID++) {
@@ -118,19 +128,12 @@ bool GA_Optimization::runOptimization() {
 				this->camDisplay->UpdateDisplay(this->bestImage->getRawData());
 			}
 			if (this->displaySLMImage) {
+				std::unique_lock<std::mutex> scalerLock(this->slmScalersMutex);
 				for (int slmID = 0; slmID < this->popCount; slmID++) {
-					this->scalers[slmID]->TranslateImage(this->population[slmID]->getGenome(this->populationSize - 1), this->slmScaledImages[slmID]);
+					this->scalers[slmID]->TranslateChanged(this->population[slmID]->getGenome(this->populationSize - 1), this->slmScaledImages[slmID]);
 					this->slmDisplayVector[slmID]->UpdateDisplay(this->slmScaledImages[slmID]);
 				}
 			}
-			// Half exposure time if fitness value is too high
-			if (this->shortenExposureFlag) {
-				this->cc->HalfExposureTime();
-				this->shortenExposureFlag = false;
-				if (this->saveExposureShorten || this->logAllFiles) {
-					this->efile << "Exposure shortened after gen: " << this->curr_gen + 1 << " with new ratio " << this->cc->GetExposureRatio() << std::endl;
-				}
-			}
 			// Output to the terminal progress to help show progress
 			if (this->curr_gen % 10 == 0) {
 				Utility::printLine("INFO: Finished generation #" + std::to_string(this->curr_gen) + " with a fitness of " + std::to_string(this->population[0]->getFitness(this->populationSize - 1)));
@@ -139,12 +142,25 @@ bool GA_Optimization::runOptimization() {
 			this->stopConditionsMetFlag = stopConditionsReached((this->population[0]->getFitness(this->populationSize - 1)*this->cc->GetExposureRatio()), this->timestamp->S_SinceStart(), this->curr_gen + 1);
 
 			// Record the time it took to perform this generation, then update start to now (for getting duration next generation)
+			// along with how many hardware evaluations the fitness cache saved
+			this->fitnessCache.endGeneration(this->curr_gen, cacheHits, cacheMisses);
 			if (this->logAllFiles || this->saveTimeVSFitness) {
 				generation_end = this->timestamp->MicroS_SinceStart();
-				this->timePerGenFile << generation_end - generation_start << std::endl;
+				this->timePerGenFile << generation_end - generation_start << "," << cacheHits << "," << cacheMisses << "," << this->fitnessCache.getSavedFrames() << ","
+					<< (this->framesResident ? "resident" : "per-frame") << std::endl;
 			}
 		} // ... optimization loop
 
+		for (int i = 0; i < this->pipelineFrames.size(); i++) {
+			delete[] this->pipelineFrames[i];
+		}
+		this->pipelineFrames.clear();
+		if (this->frameBank != NULL) {
+			delete this->frameBank;
+			this->frameBank = NULL;
+		}
+		this->endFrameMatching();
+
 		if (this->logAllFiles || this->saveTimeVSFitness) {
 			opt_end = this->timestamp->MicroS_SinceStart();
 			this->timePerGenFile << "\nOverall Time in Microseconds," << opt_end - opt_start << std::endl;
@@ -173,45 +189,93 @@ bool GA_Optimization::runOptimization() {
 }
 
 // Method for handling the execution of an individual
-// Input: indID - index value for individual being run to determine fitness (for multithreading will be the thread id as well)
+// Input: indID - index value for individual being run to determine fitness
 // Output: returns false if a critical error occurs, true otherwise
 //	individual in population index indID will have assigned fitness according to result from cc
 //	lastImgWidth,lastImgHeight updated according to result from cc
-//     shortenExposureFlag is set to true if fitness value is high enough
+//     camera exposure is shortened if the image is close to saturating
 //     stopConditionsMetFlag is set to true if conditions met
-bool GA_Optimization::runIndividual(int indID) {
-
-	ImageController * curImage = NULL;
-	// Setting up mutex locks
-	std::unique_lock<std::mutex> consoleLock(this->consoleMutex, std::defer_lock);
-	std::unique_lock<std::mutex> hardwareLock(this->hardwareMutex, std::defer_lock);
-	std::unique_lock<std::mutex> scalerLock(this->slmScalersMutex, std::defer_lock);
-
-	hardwareLock.lock();
+template <class T>
+bool GA_Optimization<T>::runIndividual(int indID) {
+	bool useCache;
+	uint64_t genomeKey;
+	if (this->lookupFitness(indID, useCache, genomeKey)) {
+		return true;
+	}
 
+	// Write the genomes of this individual to the boards and take the camera image
+	std::vector<const T*> genomes(this->popCount);
+	for (int i = 0; i < this->popCount; i++) {
+		genomes[i] = this->population[i]->getGenome(indID);
+	}
+	bool stopped = false;
+	ImageController * curImage = this->measureGenomes(genomes.data(), stopped);
 	// Pre end the result for the individual if the stop flag has been raised while waiting
-	if (this->dlg->stopFlag == true) {
-		hardwareLock.unlock();
+	if (stopped) {
 		return true;
 	}
+	return this->processImage(indID, curImage, useCache, genomeKey);
+}
 
-	// Write translated image to SLM boards, assumes there are as many boards as populations (accessing optBoards)
-	scalerLock.lock(); // Scaler lock as the scaler is closely used with the slm
-	int * genome;
+// Check the fitness cache before using the hardware, the key combines the genomes for every board
+// The best individual is always measured when its images are to be saved, or when bestImage was taken of other genomes
+// (a new elite), so the displayed and saved camera image is always that of the best genomes
+// Elites carried from the last generation are always measured again unless skipEliteReevaluation is set
+// Input:
+//	indID - index value for individual
+//	useCache - set to true if the result of measuring the individual is to be stored in the cache
+//	genomeKey - set to the cache key of the individual (when the cache is enabled)
+// Output: true if the fitness was found in the cache and assigned to the individual (no measurement needed)
+template <class T>
+bool GA_Optimization<T>::lookupFitness(int indID, bool & useCache, uint64_t & genomeKey) {
+	const bool isElite = (indID == (this->populationSize - 1));
+	const bool eliteOutput = isElite && (this->saveEliteImages) && (this->curr_gen % this->saveEliteFrequency == 0);
+	useCache = this->fitnessCache.isEnabled() && !eliteOutput;
+	genomeKey = 0;
+	if (!this->fitnessCache.isEnabled()) {
+		return false;
+	}
 	for (int i = 0; i < this->popCount; i++) {
-		// Scale the individual genome to fit SLMs
-		genome = this->population[i]->getGenome(indID);
-
-		this->scalers[i]->TranslateImage(genome, this->slmScaledImages[i]); // Translate the vector genome into char array image
-		// Write to SLM, getting the board position according to optBoards and correcting to 0 base
-		this->sc->writeImageToBoard(this->optBoards[i]->board_id, this->slmScaledImages[i]);
+		genomeKey = FitnessCache::hashGenome(this->population[i]->getGenome(indID), sizeof(T) * this->population[i]->getGenomeLength(), genomeKey);
 	}
-	scalerLock.unlock();
-
-	// Acquire image
-	curImage = this->cc->AcquireImage();
+	if (!useCache) {
+		return false;
+	}
+	if (!this->skipEliteReevaluation && this->population[0]->getFitness(indID) != -1) {
+		// Carried elite the user asked to re-measure (the new measurement is still stored)
+		return false;
+	}
+	if (isElite) {
+		// bestImage is replaced by processImage() on the processing threads
+		std::unique_lock<std::mutex> imageLock(this->imageMutex);
+		if (this->bestImage == NULL || this->bestImageKey != genomeKey) {
+			return false;
+		}
+	}
+	double cachedFitness;
+	if (this->fitnessCache.lookup(genomeKey, this->cc->GetExposureRatio(), this->curr_gen, cachedFitness)) {
+		for (int popID = 0; popID < this->population.size(); popID++) {
+			this->population[popID]->setFitness(indID, cachedFitness);
+		}
+		return true;
+	}
+	return false;
+}
 
-	hardwareLock.unlock(); // Now done with the hardware
+// Determine the fitness of an individual from its camera image, record it and save the elite output
+// Input:
+//	indID - index value for individual the image was taken of
+//	curImage - camera image of the individual (deleted here unless kept as bestImage), NULL if the acquisition failed
+//	useCache - store the result in the fitness cache
+//	genomeKey - cache key of the individual from lookupFitness()
+// Output: returns false if there is no image, true otherwise
+//	individual in population index indID will have assigned fitness
+//	camera exposure is shortened if the image is close to saturating
+template <class T>
+bool GA_Optimization<T>::processImage(int indID, ImageController * curImage, bool useCache, uint64_t genomeKey) {
+	// Setting up mutex locks
+	std::unique_lock<std::mutex> consoleLock(this->consoleMutex, std::defer_lock);
+	std::unique_lock<std::mutex> scalerLock(this->slmScalersMutex, std::defer_lock);
 
 	// Giving error and ends early if there is no data
 	if (curImage == NULL) {
@@ -220,16 +284,22 @@ bool GA_Optimization::runIndividual(int indID) {
 		consoleLock.unlock();
 		return false;
 	}
-	// Using the image data from resulting image to determine the fitness by intensity of the image within circle of target radius
-	double fitness = Utility::FindAverageValue(curImage->getRawData(), curImage->getWidth(), curImage->getHeight(), this->cc->targetRadius);
-	// Get current exposure setting of camera (relative to initial)
-	double exposureTimesRatio = this->cc->GetExposureRatio();	// needed for proper fitness value across changing exposure time
+	// Using the image data from resulting image to determine the fitness with the selected fitness function (intensity of the target by default)
+	double targetMean;
+	std::vector<double> spotMeans(this->fitnessFunction.getSpotCount());
+	double fitness = this->fitnessFunction.evaluate(curImage->getPixelData(), curImage->getPixelEncoding(), curImage->getWidth(), curImage->getHeight(), targetMean, spotMeans.data());
+	// Exposure of the frame relative to initial, needed for proper fitness value across changing exposure time
+	double exposureTimesRatio = this->cc->GetExposureRatio(curImage->getExposureTime());
+	// Shorten the exposure for the next individuals if the frames are getting close to saturating
+	controlExposure(curImage, targetMean);
+	double fitnessScale = this->fitnessFunction.fitnessScale(exposureTimesRatio); // intensities are recorded relative to the initial exposure, ratios as they are
+	bool keptAsBest = false; // curImage became bestImage (not to be deleted)
 
 	// Record files
 	if (this->logAllFiles || this->saveTimeVSFitness) {
 		std::unique_lock<std::mutex> tVfLock(this->timeVsFitMutex, std::defer_lock);
 		tVfLock.lock();
-		this->timeVsFitnessFile << this->timestamp->MS_SinceStart() << "," << fitness*exposureTimesRatio << "," << this->cc->finalExposureTime << "," << exposureTimesRatio << std::endl;
+		this->timeVsFitnessFile << this->timestamp->MS_SinceStart() << "," << fitness*fitnessScale << "," << this->cc->initialExposureTime / exposureTimesRatio << "," << exposureTimesRatio << spotColumns(spotMeans, fitnessScale, ',') << std::endl;
 		tVfLock.unlock();
 	}
 	//Save elite info of last generation
@@ -238,7 +308,7 @@ bool GA_Optimization::runIndividual(int indID) {
 			// Save Info
 			std::unique_lock<std::mutex> tFileLock(this->tfileMutex, std::defer_lock);
 			tFileLock.lock();
-			this->tfile << this->curr_gen << "," << fitness*exposureTimesRatio << std::endl;
+			this->tfile << this->curr_gen << "," << fitness*fitnessScale << std::endl;
 			tFileLock.unlock();
 			// Save camera image
 			std::string curTime = Utility::getCurDateTime(); // Get current time to use as timeStamp
@@ -246,7 +316,7 @@ bool GA_Optimization::runIndividual(int indID) {
 			// Save SLM image(s)
 			scalerLock.lock();
 			for (int popID = 0; popID < this->popCount; popID++) {
-				scalers[popID]->TranslateImage(this->population[popID]->getGenome(this->population[popID]->getSize() - 1), this->slmScaledImages[popID]);
+				scalers[popID]->TranslateChanged(this->population[popID]->getGenome(this->population[popID]->getSize() - 1), this->slmScaledImages[popID]);
 				cv::Mat m_ary = cv::Mat(this->sc->getBoardWidth(popID), this->sc->getBoardHeight(popID), CV_8UC1, this->slmScaledImages[popID]);
 				cv::imwrite(this->outputFolder + curTime + "_" + this->algorithm_name_ + "_Gen_" + std::to_string(this->curr_gen + 1) + "_Elite_SLM_" + std::to_string(this->optBoards[popID]->board_id) + ".bmp", m_ary);
 			}
@@ -257,23 +327,301 @@ bool GA_Optimization::runIndividual(int indID) {
 		imageLock.lock();
 		delete this->bestImage;
 		this->bestImage = curImage;
+		this->bestImageKey = genomeKey;
 		imageLock.unlock();
+		keptAsBest = true;
 	}
 
 	// Update fitness for the individuals
 	for (int popID = 0; popID < this->population.size(); popID++) {
-		this->population[popID]->setFitness(indID, fitness * exposureTimesRatio);
+		this->population[popID]->setFitness(indID, fitness * fitnessScale);
 	}
-	// If the fitness value is too high, flag that the exposure needs to be shortened
-	if (fitness > this->maxFitnessValue) {
-		std::unique_lock<std::mutex> exposureFlagLock(this->exposureFlagMutex, std::defer_lock);
-		exposureFlagLock.lock();
-		this->shortenExposureFlag = true;
-		exposureFlagLock.unlock();
+	if (useCache) {
+		this->fitnessCache.store(genomeKey, fitness * fitnessScale, this->cc->GetExposureRatio(), this->curr_gen);
 	}
-	// If the pointer to current image does not also point to the best image we are safe to delete
-	if (curImage != this->bestImage) {
+	// If the current image was not kept as the best image we are safe to delete
+	if (!keptAsBest) {
 		delete curImage;
 	}
 	return true;
 }
+
+// Evaluate the population with a three stage pipeline so the hardware never waits on the CPU
+//	1. scaling (a job on the thread pool) - checks the fitness cache and scales the genomes of the next individual into a free frame
+//	2. hardware (this thread) - writes the frames of an individual to the boards and acquires the image back to back
+//	3. processing (jobs on the thread pool) - fitness, logging and elite output through processImage()
+//	Stages 1 and 2 are connected by bounded queues of frame slots, so at most pipelineDepth individuals are scaled ahead
+// Output: returns false if an image acquisition failed (the remaining individuals are not measured), true otherwise
+template <class T>
+bool GA_Optimization<T>::evaluatePipelined() {
+	// Individual scaled into a frame slot waiting for the hardware, indID of -1 marks the end of the population
+	struct ScaledFrame {
+		int indID;
+		int slot;
+		bool useCache;
+		uint64_t genomeKey;
+	};
+	BoundedQueue<ScaledFrame> scaledFrames(this->pipelineDepth);
+	BoundedQueue<int> freeSlots(this->pipelineDepth);
+	for (int slot = 0; slot < this->pipelineDepth; slot++) {
+		freeSlots.push(slot);
+	}
+
+	// Lambda function for the scaling stage
+	// Captures:
+	//		this - pointer to current GA_Optimization instance
+	//		scaledFrames - queue to the hardware stage (producer)
+	//		freeSlots - frame slots returned by the hardware stage (consumer)
+	auto scaleStage = [this, &scaledFrames, &freeSlots]() {
+		for (int indID = 0; indID < this->populationSize; indID++) {
+			// If skipping already evaluated toggled and this individual already has a fitness (not initial -1) then skip
+			if (this->skipEliteReevaluation == true && this->population[0]->getFitness(indID) != -1) {
+				continue;
+			}
+			ScaledFrame frame;
+			frame.indID = indID;
+			if (this->lookupFitness(indID, frame.useCache, frame.genomeKey)) {
+				continue;
+			}
+			frame.slot = freeSlots.pop();
+			// The scalers are also used by processImage() to save the elite images
+			std::unique_lock<std::mutex> scalerLock(this->slmScalersMutex);
+			for (int i = 0; i < this->popCount; i++) {
+				this->scalers[i]->TranslateImage(this->population[i]->getGenome(indID), this->pipelineFrames[frame.slot * this->popCount + i]);
+			}
+			scalerLock.unlock();
+			scaledFrames.push(frame);
+		}
+		ScaledFrame end;
+		end.indID = -1;
+		scaledFrames.push(end);
+	};
+
+	// Lambda function for the processing stage
+	// Input: frame - the individual measured
+	//		  curImage - its camera image
+	// Captures: this - pointer to current GA_Optimization instance
+	auto processStage = [this](const ScaledFrame frame, ImageController * curImage) {
+		this->processImage(frame.indID, curImage, frame.useCache, frame.genomeKey);
+	};
+
+	this->myThreadPool_->pushJob(scaleStage);
+
+	// Hardware stage, runs until the scaling stage marks the end so every frame slot is handed back
+	// (a camera exception is held until then, the scaling stage still uses the queues on this stack)
+	bool success = true;
+	std::exception_ptr hardwareError;	// Set if the camera or SLM threw
+	for (ScaledFrame frame = scaledFrames.pop(); frame.indID != -1; frame = scaledFrames.pop()) {
+		ImageController * curImage = NULL;
+		if (success && this->dlg->stopFlag == false) {
+			try {
+				for (int i = 0; i < this->popCount; i++) {
+					this->sc->writeImageToBoard(this->optBoards[i]->board_id, this->pipelineFrames[frame.slot * this->popCount + i]);
+				}
+				curImage = this->acquireAfterWrite();
+			}
+			catch (...) {
+				hardwareError = std::current_exception();
+			}
+			if (curImage == NULL) {
+				Utility::printLine("ERROR: Image Acquisition has failed!");
+				success = false;
+			}
+		}
+		freeSlots.push(frame.slot);
+		if (curImage != NULL) {
+			this->myThreadPool_->pushJob(std::bind(processStage, frame, curImage));
+		}
+	}
+	this->myThreadPool_->wait();
+	if (hardwareError) {
+		std::rethrow_exception(hardwareError);
+	}
+	return success;
+}
+
+// Evaluate the population with every frame to be measured uploaded to SLM RAM at once (see SLMFrameBank.h)
+//	Frames are scaled into the bank (on the thread pool when multithreading), uploaded, then each individual selects
+//	its frame and acquires the image, with the images processed on the thread pool while the next one is taken
+// Output: returns false if selecting a frame or an image acquisition failed (the remaining individuals are not measured), true otherwise
+template <class T>
+bool GA_Optimization<T>::evaluateBatched() {
+	// Individuals to measure (not skipped and not found in the fitness cache), slot k of the bank holds measured[k]
+	std::vector<int> measured;
+	std::vector<bool> useCache;
+	std::vector<uint64_t> genomeKeys;
+	for (int indID = 0; indID < this->populationSize; indID++) {
+		// If skipping already evaluated toggled and this individual already has a fitness (not initial -1) then skip
+		if (this->skipEliteReevaluation == true && this->population[0]->getFitness(indID) != -1) {
+			continue;
+		}
+		bool indUseCache;
+		uint64_t genomeKey;
+		if (!this->lookupFitness(indID, indUseCache, genomeKey)) {
+			measured.push_back(indID);
+			useCache.push_back(indUseCache);
+			genomeKeys.push_back(genomeKey);
+		}
+	}
+	const int measureCount = int(measured.size());
+
+	// Lambda function to scale a group of the individuals into their slots of the bank
+	// Each thread scales with its own copy of the scalers, as a scaler keeps working state of the frame it renders
+	// Input: threadID - this thread
+	//		  numThreads - total number of threads being run
+	// Captures:
+	//		this - pointer to current GA_Optimization instance
+	//		measured - individual of each slot
+	auto scaleSubGroup = [this, &measured, measureCount](const int threadID, const int numThreads) {
+		std::unique_lock<std::mutex> scalerLock(this->slmScalersMutex);
+		std::vector<ImageScaler> threadScalers;
+		for (int i = 0; i < this->popCount; i++) {
+			threadScalers.push_back(*this->scalers[i]);
+		}
+		scalerLock.unlock();
+		for (int slot = threadID; slot < measureCount; slot += numThreads) {
+			for (int i = 0; i < this->popCount; i++) {
+				threadScalers[i].TranslateImage(this->population[i]->getGenome(measured[slot]), this->frameBank->frame(i, slot));
+			}
+		}
+	};
+	if (this->multithreadEnable) {
+		for (int threadID = 0; threadID < this->gaPoolThreadCount; threadID++) {
+			this->myThreadPool_->pushJob(std::bind(scaleSubGroup, threadID, this->gaPoolThreadCount));
+		}
+		this->myThreadPool_->wait();
+	}
+	else {
+		scaleSubGroup(0, 1);
+	}
+	// Fitness of what the boards show, for the bank to verify that selecting a slot shows its frame
+	// Captures: this - pointer to current GA_Optimization instance
+	auto measureShown = [this]() {
+		ImageController * curImage = this->acquireAfterWrite();
+		if (curImage == NULL) {
+			return -1.0;
+		}
+		double targetMean;
+		const double rawFitness = this->fitnessFunction.evaluate(curImage->getPixelData(), curImage->getPixelEncoding(), curImage->getWidth(), curImage->getHeight(), targetMean, NULL);
+		const double fitness = rawFitness * this->fitnessFunction.fitnessScale(this->cc->GetExposureRatio(curImage->getExposureTime()));
+		delete curImage;
+		return fitness;
+	};
+	// Record which path this generation used, so its timing is not compared as if the frames were resident when they were written
+	const bool wasResident = this->framesResident;
+	this->framesResident = this->frameBank->upload(measureCount, measureShown);
+	if (this->framesResident) {
+		this->residentFrameGenerations++;
+	}
+	if (this->framesResident != wasResident || this->curr_gen == 0) {
+		Utility::printLine("INFO: Generation #" + std::to_string(this->curr_gen) + (this->framesResident ? " selecting SLM frames from board RAM" : " writing SLM frames individually"));
+	}
+
+	bool success = true;
+	for (int slot = 0; slot < measureCount && this->dlg->stopFlag == false; slot++) {
+		if (!this->frameBank->select(slot)) {
+			Utility::printLine("ERROR: Failed to select SLM frame!");
+			success = false;
+			break;
+		}
+		ImageController * curImage = this->acquireAfterWrite();
+		if (curImage == NULL) {
+			Utility::printLine("ERROR: Image Acquisition has failed!");
+			success = false;
+			break;
+		}
+		if (this->multithreadEnable) {
+			this->myThreadPool_->pushJob(std::bind(&GA_Optimization<T>::processImage, this, measured[slot], curImage, bool(useCache[slot]), genomeKeys[slot]));
+		}
+		else {
+			this->processImage(measured[slot], curImage, useCache[slot], genomeKeys[slot]);
+		}
+	}
+	if (this->multithreadEnable) {
+		this->myThreadPool_->wait();
+	}
+	return success;
+}
+
+// Write a genome to each board being optimized and take a camera image of the result, holding the hardware for the duration
+// Input:
+//	genomes - genome for each population (board), popCount pointers
+//	stopped - set to true if the stop flag was raised while waiting for the hardware (nothing is written)
+// Output: the camera image (to be deleted by the caller), NULL if stopped or the acquisition failed
+template <class T>
+ImageController * GA_Optimization<T>::measureGenomes(const T * const * genomes, bool & stopped) {
+	std::unique_lock<std::mutex> hardwareLock(this->hardwareMutex);
+
+	if (this->dlg->stopFlag == true) {
+		stopped = true;
+		return NULL;
+	}
+	stopped = false;
+
+	// Write translated image to SLM boards, assumes there are as many boards as populations (accessing optBoards)
+	std::unique_lock<std::mutex> scalerLock(this->slmScalersMutex); // Scaler lock as the scaler is closely used with the slm
+	for (int i = 0; i < this->popCount; i++) {
+		// Scale the individual genome to fit SLMs, only rendering the bins that differ from the frame written before
+		this->scalers[i]->TranslateChanged(genomes[i], this->slmScaledImages[i]); // Translate the vector genome into char array image
+		// Write to SLM, getting the board position according to optBoards and correcting to 0 base
+		this->sc->writeImageToBoard(this->optBoards[i]->board_id, this->slmScaledImages[i]);
+	}
+	scalerLock.unlock();
+
+	// Acquire image
+	return this->acquireAfterWrite();
+}
+
+// Take the camera image of the pattern just written to the boards (called while holding the hardware)
+//	Without frame matching this is the next camera image, otherwise frames are taken until one is exposed
+//	entirely after the pattern settled (the camera may run faster than the SLM settles, early frames are discarded)
+//	A shorter exposure queued by the frames processed since the last acquisition is set on the camera first
+// Output: the camera image (to be deleted by the caller), NULL if the acquisition failed or no frame matched within a second of frames
+template <class T>
+ImageController * GA_Optimization<T>::acquireAfterWrite() {
+	this->applyPendingExposure();
+	if (this->frameMatcher == NULL) {
+		return this->cc->AcquireImage();
+	}
+	const long long seq = this->frameMatcher->patternWritten();
+	// Limit the wait to about a second of frames in case the timestamps never satisfy the matcher
+	const int maxFrames = (std::max)(this->cc->fps, 1);
+	for (int frames = 0; frames < maxFrames; frames++) {
+		FrameStamp stamp;
+		ImageController * curImage = this->cc->AcquireImage(stamp);
+		if (curImage == NULL) {
+			this->frameMatcher->clearPending();
+			return NULL;
+		}
+		if (this->frameMatcher->offerFrame(stamp) == seq) {
+			return curImage;
+		}
+		delete curImage;
+	}
+	Utility::printLine("ERROR: No camera frame was exposed after the SLM pattern settled!");
+	this->frameMatcher->clearPending();
+	return NULL;
+}
+
+// Create the frame matcher for a run if useFrameMatching (called before the optimization loop)
+template <class T>
+void GA_Optimization<T>::startFrameMatching() {
+	if (this->useFrameMatching) {
+		this->frameMatcher = new FrameMatcher<>((long long)(this->slmSettleTime * 1000));
+	}
+}
+
+// Report the frame matcher counters and delete it (called after the optimization loop)
+template <class T>
+void GA_Optimization<T>::endFrameMatching() {
+	if (this->frameMatcher != NULL) {
+		Utility::printLine("INFO: Synchronized acquisition matched " + std::to_string(this->frameMatcher->getMatchedCount()) + " frames, discarded "
+			+ std::to_string(this->frameMatcher->getDiscardedCount()) + " unsettled frames, camera dropped " + std::to_string(this->frameMatcher->getDroppedCount()));
+		delete this->frameMatcher;
+		this->frameMatcher = NULL;
+	}
+}
+
+// Gene types the genetic algorithms can be built with
+template class GA_Optimization<unsigned char>;
+template class GA_Optimization<unsigned short>;
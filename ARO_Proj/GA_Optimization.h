@@ -6,16 +6,23 @@
 
 #include "Optimization.h"
 #include "Population.h"
+#include "FitnessCache.h"	// Skip hardware evaluation of recently measured genomes
+#include "BoundedQueue.h"	// Hand off between the stages of evaluatePipelined()
+#include "SLMFrameBank.h"	// Generation of frames staged in SLM RAM for evaluateBatched()
+#include "FrameMatcher.h"	// Pairs written patterns with settled camera frames (useFrameMatching)
 
 #include "threadPool.h"
 
 #ifndef GA_OPTIMIZATION_H_
 #define GA_OPTIMIZATION_H_
 
+// T - gene type of the populations (see GenomeTraits.h), unsigned char for 8 bit SLMs or unsigned short for 16 bit SLMs
+//	   Implemented in GA_Optimization.cpp and instantiated there for unsigned char and unsigned short
+template <class T>
 class GA_Optimization : public Optimization {
 protected:
 	// Vector to hold genetic algorithm's populations
-	std::vector<Population<int>*> population;
+	std::vector<Population<T>*> population;
 	threadPool * myThreadPool_;
 
 	int populationSize;	// Size of the populations being used (number of individuals in a population class)
@@ -25,6 +32,23 @@ protected:
 	int indThreadCount;	// Number of threads to use when evaluating individuals
 	int gaPoolThreadCount;	// Number of threads to use when generating the next generation
 
+	// Fitness cache, an individual whose genomes were measured within fitnessCacheTTL generations at the same exposure is not re-measured
+	// (reset from useFitnessCache and fitnessCacheTTL at the start of each run)
+	FitnessCache fitnessCache;
+	uint64_t bestImageKey = 0;		// Cache key of the genomes bestImage was taken of (when the cache is enabled)
+
+	// Evaluation pipeline used when multithreading (see evaluatePipelined())
+	int pipelineDepth = 3;	// Number of individuals that can be scaled ahead of the hardware
+	std::vector<unsigned char*> pipelineFrames;	// Frame slots, board i of slot s at [s * popCount + i]
+
+	// Frames of the individuals of a generation staged in SLM RAM (when useSLMFrameBank, see evaluateBatched()), NULL otherwise
+	SLMFrameBank<Blink_SDK> * frameBank = NULL;
+	// True if the frames of the generation being evaluated were selected from SLM RAM, false if written individually (logged per generation)
+	bool framesResident = false;
+
+	// Pairs each pattern written with the first camera frame exposed after it settled (when useFrameMatching), NULL otherwise
+	FrameMatcher<> * frameMatcher = NULL;
+
 	// GA specific output file stream
 	std::ofstream timePerGenFile;		// Record time it took to perform each generation during optimization
 
@@ -32,9 +56,27 @@ protected:
 	std::mutex hardwareMutex;						// Mutex to protect critical section of accessing SLM and Camera data
 	std::mutex consoleMutex, imageMutex;			// Mutex to protect console output and bestImage values
 	std::mutex tfileMutex, timeVsFitMutex;			// Mutex to protect file i/o
-	std::mutex exposureFlagMutex;					// Mutex to protect important flag(s)
 	std::mutex slmScalersMutex; // Mutex to protect the usage of the the SLM scalers (which are used in both for hardware and in image output)
 
+	// Write a genome to each board being optimized and take a camera image of the result (holds the hardware for the duration)
+	// Input:
+	//		genomes - genome for each population (board), popCount pointers
+	//		stopped - set to true if the stop flag was raised while waiting for the hardware (nothing is written)
+	// Output: the camera image (to be deleted by the caller), NULL if stopped or the acquisition failed
+	ImageController * measureGenomes(const T * const * genomes, bool & stopped);
+
+	// Take the camera image of the pattern just written to the boards (called while holding the hardware)
+	// When useFrameMatching, frames exposed before the pattern settled are discarded until a matching one arrives
+	// A shorter exposure queued by controlExposure() is set on the camera first
+	// Output: the camera image (to be deleted by the caller), NULL if the acquisition failed or no frame matched within a second of frames
+	ImageController * acquireAfterWrite();
+
+	// Create the frame matcher for a run if useFrameMatching (called before the optimization loop)
+	void startFrameMatching();
+
+	// Report the frame matcher counters and delete it (called after the optimization loop)
+	void endFrameMatching();
+
 	// Method for handling the execution of an individual
 	// Input:
 	//		indID - index value for individual being run to determine fitness (for multithreading will be the thread id as well)
@@ -42,10 +84,37 @@ protected:
 	// Output: returns false if a critical error occurs, true otherwise
 	//		individual in population index indID will have assigned fitness according to result from cc
 	//		lastImgWidth,lastImgHeight updated according to result from cc
-	//		shortenExposureFlag is set to true if fitness value is high enough
+	//		camera exposure is shortened if the image is close to saturating
 	//		stopConditionsMetFlag is set to true if conditions met
 	bool runIndividual(int indID);
 
+	// Check the fitness cache for an individual before measuring it
+	// Input:
+	//		indID - index value for individual
+	//		useCache - set to true if the measured fitness is to be stored in the cache
+	//		genomeKey - set to the cache key of the individual
+	// Output: true if the cached fitness was assigned to the individual (no measurement needed),
+	//		   never for the best individual when its genomes are not those bestImage was taken of
+	bool lookupFitness(int indID, bool & useCache, uint64_t & genomeKey);
+
+	// Determine, record and assign the fitness of an individual from its camera image (deleted unless kept as bestImage)
+	// Input:
+	//		indID - index value for individual the image was taken of
+	//		curImage - camera image of the individual, NULL if the acquisition failed
+	//		useCache, genomeKey - from lookupFitness()
+	// Output: returns false if there is no image, true otherwise
+	bool processImage(int indID, ImageController * curImage, bool useCache, uint64_t genomeKey);
+
+	// Evaluate the population, overlapping genome scaling, the hardware and image processing (used when multithreading)
+	// Output: returns false if an image acquisition failed, true otherwise
+	bool evaluatePipelined();
+
+	// Evaluate the population by uploading the frames of every individual to be measured to SLM RAM at once,
+	// then for each individual only selecting its frame and acquiring the image (used when useSLMFrameBank)
+	// Until the bank verified its frames are resident (see SLMFrameBank::upload()) each frame is written with Write_image
+	// Output: returns false if selecting a frame or an image acquisition failed, true otherwise
+	bool evaluateBatched();
+
 public:
 	// Constructor - inherits from base class
 	GA_Optimization(MainDialog* dlg, CameraController* cc, SLMController* sc) : Optimization(dlg, cc, sc) {
@@ -0,0 +1,138 @@
+////////////////////
+// GenomeArena.h - contiguous pool of reference counted genome slots for a population
+////////////////////
+
+#ifndef GENOME_ARENA_H_
+#define GENOME_ARENA_H_
+
+#include <malloc.h>	// _aligned_malloc() & _aligned_free()
+#include <cstring>	// memset()
+
+// Alignment (in bytes) of every genome within the arena, a cache line so genomes never share one and SIMD loads are aligned
+#define GENOME_ALIGNMENT 64
+
+// Holds every genome of a population in one aligned slab of slots, each with a reference count
+// A genome is written once when its slot is acquired (crossover or random fill) and is immutable afterwards,
+// so an elite carried into the next generation shares its slot (retain) instead of being copied.
+// With 2 * population size slots the current and next generation always fit, so no allocations are made per generation.
+// acquire/retain/release are not thread safe, the population calls them from the thread running nextGeneration()
+template <class T>
+class GenomeArena {
+private:
+	// The slots, slot i starts at slab_ + i * stride_
+	T * slab_;
+	// Reference count of each slot (0 if free)
+	int * ref_counts_;
+	// Stack of free slots
+	int * free_slots_;
+	int free_count_;
+	// Number of slots
+	int count_;
+	// Number of elements in a genome
+	int genome_length_;
+	// Number of elements between the start of two genomes (genome_length_ rounded up to the alignment)
+	int stride_;
+
+public:
+	// Constructor
+	// Input:
+	//	genome_length: number of elements in each genome
+	//	count:		   number of slots (2 * population size for a generational population)
+	GenomeArena(int genome_length, int count) {
+		this->genome_length_ = genome_length;
+		this->count_ = count;
+		const int genome_bytes = int(sizeof(T)) * genome_length;
+		this->stride_ = ((genome_bytes + GENOME_ALIGNMENT - 1) / GENOME_ALIGNMENT) * GENOME_ALIGNMENT / int(sizeof(T));
+
+		const size_t slab_bytes = size_t(this->stride_) * sizeof(T) * this->count_;
+		this->slab_ = static_cast<T*>(_aligned_malloc(slab_bytes, GENOME_ALIGNMENT));
+		if (this->slab_ == NULL) {
+			// No slots to hand out, acquire() returns NULL (see isAllocated())
+			this->count_ = 0;
+		}
+		else {
+			// Zero so the padding between genomes is deterministic
+			memset(this->slab_, 0, slab_bytes);
+		}
+
+		this->ref_counts_ = new int[this->count_];
+		this->free_slots_ = new int[this->count_];
+		// Free stack is filled so the lowest slots are handed out first
+		for (int i = 0; i < this->count_; i++) {
+			this->ref_counts_[i] = 0;
+			this->free_slots_[i] = this->count_ - 1 - i;
+		}
+		this->free_count_ = this->count_;
+	}
+
+	// Destructor - frees the slab
+	~GenomeArena() {
+		_aligned_free(this->slab_);
+		delete[] this->ref_counts_;
+		delete[] this->free_slots_;
+	}
+
+	GenomeArena(const GenomeArena & other) = delete;
+	GenomeArena& operator=(const GenomeArena & other) = delete;
+
+	// Take a free slot for a new genome, its reference count is 1
+	// Output: pointer to the genome storage of the slot (to be written once by the caller), NULL if the arena is exhausted
+	T * acquire() {
+		if (this->free_count_ == 0) {
+			return NULL;
+		}
+		const int slot = this->free_slots_[--this->free_count_];
+		this->ref_counts_[slot] = 1;
+		return this->genome(slot);
+	}
+
+	// Add a reference to the slot holding genome (such as an elite carried into the next generation)
+	void retain(const T * genome) {
+		this->ref_counts_[this->slotOf(genome)]++;
+	}
+
+	// Remove a reference to the slot holding genome, the slot is free again once no references remain
+	void release(const T * genome) {
+		const int slot = this->slotOf(genome);
+		if (--this->ref_counts_[slot] == 0) {
+			this->free_slots_[this->free_count_++] = slot;
+		}
+	}
+
+	// Pointer to the genome at slot i
+	T * genome(int i) const {
+		return this->slab_ + size_t(i) * this->stride_;
+	}
+
+	// Slot index of a genome pointer handed out by this arena
+	int slotOf(const T * genome) const {
+		return int((genome - this->slab_) / this->stride_);
+	}
+
+	// Number of references to the slot holding genome
+	const int getRefCount(const T * genome) const {
+		return this->ref_counts_[this->slotOf(genome)];
+	}
+
+	// Number of elements between the start of two consecutive genomes
+	const int getStride() const {
+		return this->stride_;
+	}
+
+	// True if the slab could be allocated
+	const bool isAllocated() const {
+		return this->slab_ != NULL;
+	}
+
+	// Number of slots (0 if the slab could not be allocated)
+	const int getCount() const {
+		return this->count_;
+	}
+
+	// Number of slots not in use
+	const int getFreeCount() const {
+		return this->free_count_;
+	}
+};
+
+#endif
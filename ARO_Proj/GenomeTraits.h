@@ -0,0 +1,37 @@
+////////////////////
+// GenomeTraits.h - properties of the gene types a population (and ImageScaler) can be built with
+////////////////////
+
+#ifndef GENOME_TRAITS_H_
+#define GENOME_TRAITS_H_
+
+#include "FastRandom.h"	// bounded() in randomGene()
+
+// Default for 8 bit phase values (unsigned char, and int as used by BruteForce)
+template <class T>
+struct GenomeTraits {
+	// Number of phase levels a gene can take, values are in [0, levels)
+	static const int levels = 256;
+	// Right shift that takes a gene to the 8 bit value written into a depth 1 SLM image
+	static const int depth1_shift = 0;
+	// True if every bit pattern of T is a valid gene, so random genes can be filled as raw bytes
+	static const bool full_range = (sizeof(T) == 1);
+};
+
+// 16 bit phase values for 16 bit SLMs, on a depth 1 (8 bit) board only the high byte is written
+template <>
+struct GenomeTraits<unsigned short> {
+	static const int levels = 65536;
+	static const int depth1_shift = 8;
+	static const bool full_range = true;
+};
+
+// Draw a random gene uniformly over the phase levels of T
+// Input: rng_machine - the RNG object to use
+// Output: random value in [0, GenomeTraits<T>::levels)
+template <class T>
+inline T randomGene(FastRandom * rng_machine) {
+	return T(rng_machine->bounded(GenomeTraits<T>::levels));
+}
+
+#endif
@@ -11,7 +11,14 @@
 #include <opencv2\core\core.hpp> // Using OpenCV to save image info
 #include <opencv2\highgui\highgui.hpp>
 
-// Note / TODO: Consider how to handle issue of image size received being larger (16 bit versus 8 bit)
+#include <cstring>				// memcpy()
+
+#include "FrameBufferPool.h"	// Pooled frame buffers
+#include "PixelConvert.h"		// narrow16To8()
+#include "PixelTraits.h"		// PixelEncoding
+
+// Frames from the camera keep their 16 bit pixels (getPixelData()) for the fitness, the 8 bit image (getRawData()) used
+// for display and saving is only converted when first asked for
 
 class ImageController {
 private:
@@ -19,30 +26,27 @@ private:
 	int width_;			   // Width of the image in pixels
 	int height_;		   // Height of the image in pixels
 	int size_;			   // Total size of the image in bytes (which should be with current format equal to width*height)
+	PooledBuffer buffer_;  // Pooled buffer holding the 16 bit pixels when constructed from a camera frame, empty otherwise
+	double exposureTime_ = 0; // Exposure the frame was taken with (us), 0 if not known
 public:
 	ImageController() {
 		this->data_ = nullptr;
 		this->size_ = 0;
 	}
 
-	// Constructor with set image to assign
-	// Performs deep copy, original should be safe to release
-	// Input:	rawData - pointer to image data (integer format, so needs to be compressed)
-	//			size - number of elements in rawData
+	// Constructor copying the 16 bit pixels into a pooled buffer, the buffer returns to its pool when this is deleted
+	// Input:	rawData - pointer to image data (16 bit, kept at full precision)
+	//			size - number of elements in rawData (buffer must hold at least 2*size bytes)
 	//		    width - width of the image in pixels
 	//			height - height of the image in piels
-	ImageController(unsigned short * rawData, int size, int width, int height) {
+	//			buffer - buffer for the 16 bit image (moved in)
+	ImageController(const unsigned short * rawData, int size, int width, int height, PooledBuffer && buffer) : buffer_(std::move(buffer)) {
 		this->size_ = size;
 		this->width_ = width;
 		this->height_ = height;
 
-		this->data_ = new unsigned char[size];
-		for (int index = 0; index < size; index++) {
-			// Attempting a kind of compression to convert short size value to byte size (1/2 the size) by dividing it down so max is reduced to 255 and so on.
-			// Note that this not at all a lossless compression, but should work to having data comparable to Spinnaker's
-			unsigned char byteData = unsigned char(rawData[index] / 257);
-			this->data_[index] = byteData;
-		}
+		this->data_ = nullptr;
+		memcpy(this->buffer_.get(), rawData, size_t(size) * 2);
 	}
 
 	// Copy constructor
@@ -50,6 +54,7 @@ public:
 		this->width_ = other.getWidth();
 		this->height_ = other.getHeight();
 		this->size_ = other.getSize();
+		this->exposureTime_ = other.getExposureTime();
 		unsigned char * otherData = other.getRawData();
 
 		this->data_ = new unsigned char[this->size_];
@@ -68,11 +73,37 @@ public:
 		return this->size_;
 	}
 
-	// Returns pointer to data associated with the image
+	// Returns pointer to data associated with the image (8 bit, converted from the 16 bit pixels on first call)
 	unsigned char * getRawData() {
+		if (this->data_ == nullptr && this->buffer_.get() != NULL) {
+			this->data_ = new unsigned char[this->size_];
+			PixelConvert::narrow16To8((const unsigned short *)this->buffer_.get(), this->data_, this->size_);
+		}
 		return this->data_;
 	}
 
+	// Returns pointer to the pixels in their native encoding (16 bit from the camera, see getPixelEncoding())
+	const void * getPixelData() {
+		if (this->buffer_.get() != NULL) {
+			return this->buffer_.get();
+		}
+		return this->data_;
+	}
+
+	// Encoding of getPixelData()
+	const PixelEncoding getPixelEncoding() {
+		return (this->buffer_.get() != NULL) ? PixelEncoding::Mono16 : PixelEncoding::Mono8;
+	}
+
+	// Exposure the frame was taken with in microseconds (set by the camera controller, 0 if not known)
+	const double getExposureTime() {
+		return this->exposureTime_;
+	}
+
+	void setExposureTime(double exposureTime) {
+		this->exposureTime_ = exposureTime;
+	}
+
 	// Return width of the Image
 	const int getWidth() {
 		return this->width_;
@@ -86,7 +117,7 @@ public:
 	// Output the image with given file path
 	void saveImage(std::string path) {
 		// PICam does not offer it's own method of saving images, so using OpenCV's
-		cv::imwrite(path, cv::Mat(this->height_, this->width_, CV_8UC1, this->data_));
+		cv::imwrite(path, cv::Mat(this->height_, this->width_, CV_8UC1, this->getRawData()));
 	}
 };
 
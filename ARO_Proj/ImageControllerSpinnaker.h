@@ -8,16 +8,26 @@
 
 #ifdef USE_SPINNAKER // Only include implementation if building with Spinnaker
 
+#include <atomic>
+#include <memory>
+
 #include "Spinnaker.h"
 #include "SpinGenApi\SpinnakerGenApi.h"
 using namespace Spinnaker::GenApi;
 
+#include "FrameBufferPool.h"	// Pooled frame buffers
+#include "PixelTraits.h"		// PixelEncoding
+
 // Class to encaspsulate interactions required to accessing image data and current SDK
 //		(this is so that optimization classes aren't relying on an SDK's specific behaviors)
 class ImageController {
 private:
+	PooledBuffer buffer_;		// Buffer holding the image data if it came from a FrameBufferPool (declared first so it outlives image_)
 	Spinnaker::ImagePtr image_; // Pointer to Image in Spinnaker SDK
+	Spinnaker::ImagePtr mono8_; // Mono8 conversion of image_ for getRawData() when image_ is 16 or 12 bit (made on first call)
 	bool needRelease;
+	std::shared_ptr<std::atomic<int>> heldCount_; // Count of camera buffers held as views, decremented on release (views only)
+	double exposureTime_ = 0;	// Exposure the frame was taken with (us), 0 if not known
 public:
 	ImageController() {
 		this->image_ = Spinnaker::Image::Create();
@@ -34,6 +44,23 @@ public:
 		this->needRelease = release;
 	}
 
+	// Constructor viewing a camera buffer without copying, the buffer is handed back to the camera when this is deleted
+	// Input:	cameraImage - image from GetNextImage() (not yet released)
+	//			heldCount - count of camera buffers held by views, incremented until this is deleted
+	ImageController(Spinnaker::ImagePtr& cameraImage, const std::shared_ptr<std::atomic<int>> & heldCount) : heldCount_(heldCount) {
+		this->image_ = cameraImage;
+		this->needRelease = true;
+		this->heldCount_->fetch_add(1);
+	}
+
+	// Constructor taking an image whose data is a pooled buffer, the buffer returns to its pool when this is deleted
+	// Input:	pooledImage - image created over buffer's data
+	//			buffer - the buffer (moved in)
+	ImageController(Spinnaker::ImagePtr& pooledImage, PooledBuffer && buffer) : buffer_(std::move(buffer)) {
+		this->image_ = pooledImage;
+		this->needRelease = false;
+	}
+
 	ImageController(ImageController & other) {
 		if (this->needRelease) 
 			this->image_->Release();
@@ -42,13 +69,21 @@ public:
 		this->image_ = Spinnaker::Image::Create();
 		this->image_->DeepCopy(other.getImage());
 		this->needRelease = other.getReleaseBool();
+		this->exposureTime_ = other.getExposureTime();
 	}
 
 	// Desturctor - checks if need to call Release()
 	~ImageController() {
-		if (this->needRelease)
+		if (this->needRelease) {
+			// Camera buffer goes back to the camera, the camera owns the image
 			this->image_->Release();
-		this->image_->~IImage();
+			if (this->heldCount_) {
+				this->heldCount_->fetch_sub(1);
+			}
+		}
+		else {
+			this->image_->~IImage();
+		}
 	}
 
 	Spinnaker::ImagePtr getImage() {
@@ -60,9 +95,41 @@ public:
 		return this->needRelease;
 	}
 
-	// Returns pointer to data associated with the image
+	// Returns pointer to data associated with the image (8 bit, converted on first call if the image has deeper pixels)
 	unsigned char * getRawData() {
-		return static_cast<unsigned char *>(this->image_->GetData());
+		if (this->image_->GetPixelFormat() == Spinnaker::PixelFormat_Mono8) {
+			return static_cast<unsigned char *>(this->image_->GetData());
+		}
+		if (!this->mono8_) {
+			this->mono8_ = this->image_->Convert(Spinnaker::PixelFormat_Mono8);
+		}
+		return static_cast<unsigned char *>(this->mono8_->GetData());
+	}
+
+	// Returns pointer to the pixels in their native encoding (see getPixelEncoding())
+	const void * getPixelData() {
+		return this->image_->GetData();
+	}
+
+	// Encoding of getPixelData()
+	const PixelEncoding getPixelEncoding() {
+		switch (this->image_->GetPixelFormat()) {
+		case Spinnaker::PixelFormat_Mono16:
+			return PixelEncoding::Mono16;
+		case Spinnaker::PixelFormat_Mono12p:
+			return PixelEncoding::Mono12p;
+		default:
+			return PixelEncoding::Mono8;
+		}
+	}
+
+	// Exposure the frame was taken with in microseconds (set by the camera controller, 0 if not known)
+	const double getExposureTime() {
+		return this->exposureTime_;
+	}
+
+	void setExposureTime(double exposureTime) {
+		this->exposureTime_ = exposureTime;
 	}
 
 	// Return width of the Image
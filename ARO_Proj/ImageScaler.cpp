@@ -5,8 +5,20 @@
 
 #include "stdafx.h"
 #include "ImageScaler.h"
+#include "GenomeTraits.h"	// depth1_shift for 16 bit genes
 
 #include <algorithm> // max() and min()
+#include <cstring>	 // memcpy()
+
+// Instruction set is chosen at compile time, AVX2 when building with /arch:AVX2 otherwise SSE2 (always present on x64)
+// Define IMAGE_SCALER_FORCE_SCALAR to use the plain C++ path
+#if !defined(IMAGE_SCALER_FORCE_SCALAR) && defined(__AVX2__)
+#define IMAGE_SCALER_AVX2
+#include <immintrin.h>
+#elif !defined(IMAGE_SCALER_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define IMAGE_SCALER_SSE2
+#include <emmintrin.h>
+#endif
 
 // Constructor
 // Input: output_image_width - x diminsion size of output image
@@ -20,6 +32,7 @@ output_image_width_(output_image_width), output_image_height_(output_image_heigh
 	remainder_x_ = remainder_y_ = -1;
 	left_remainder_x_ = top_remainder_y_ = -1;
 	requirement_set_bin_size_ = requirement_set_used_bins_ = false;
+	rendered_frame_ = NULL;
 }
 
 // Set bin size
@@ -33,6 +46,8 @@ void ImageScaler::SetBinSize(int bin_size_x, int bin_size_y) {
 	remainder_x_ = output_image_width_ % bin_size_x;
 	remainder_y_ = output_image_height_ % bin_size_y;
 	requirement_set_bin_size_ = true;
+	modal_basis_ = NULL; // The cells changed
+	InvalidateRendered();
 }
 
 // Get the maximum number of bins based on image size and bin size
@@ -54,13 +69,92 @@ void ImageScaler::SetUsedBins(int used_bins_x, int used_bins_y) {
 	left_remainder_x_ = remainder_x_ / 2;
 	top_remainder_y_ = (remainder_y_ / 2) *output_image_width_;
 	requirement_set_used_bins_ = true;
+	modal_basis_ = NULL;
+	InvalidateRendered();
+}
+
+// Use an index map for the bins
+// Input: index_map - per pixel gene index of the output image size, NULL for the rectangular bins
+// Output: false if the size does not match
+bool ImageScaler::SetIndexMap(std::shared_ptr<const IndexMap> index_map) {
+	if (index_map != NULL && (index_map->getWidth() != output_image_width_ || index_map->getHeight() != output_image_height_)) {
+		return false;
+	}
+	index_map_ = index_map;
+	modal_basis_ = NULL;
+	InvalidateRendered();
+	return true;
+}
+
+// Use a modal basis for the input images
+// Input: modal_basis - modes sampled at the cells of this scaler, NULL for a gene per cell
+// Output: false if the number of cells does not match
+bool ImageScaler::SetModalBasis(std::shared_ptr<const ModalBasis> modal_basis) {
+	if (modal_basis != NULL && (!IsReady() || modal_basis->getCellCount() != CellCount())) {
+		return false;
+	}
+	modal_basis_ = modal_basis;
+	InvalidateRendered();
+	return true;
+}
+
+// Use a phase correction stage
+// Input: phase_correction - the stage, NULL for none
+// Output: false if the output is not depth 1 or the size does not match
+bool ImageScaler::SetPhaseCorrection(std::shared_ptr<const PhaseCorrection> phase_correction) {
+	if (phase_correction != NULL && (output_image_depth_ != 1 || phase_correction->getWidth() != output_image_width_ || phase_correction->getHeight() != output_image_height_)) {
+		return false;
+	}
+	phase_correction_ = (phase_correction != NULL && phase_correction->isActive()) ? phase_correction : NULL;
+	InvalidateRendered();
+	return true;
+}
+
+// Get the center of each cell
+// Input: center_x, center_y - set to the x and y positions of the cells in pixels, in cell order
+void ImageScaler::GetCellCenters(std::vector<double> &center_x, std::vector<double> &center_y) {
+	center_x.assign(CellCount(), 0);
+	center_y.assign(CellCount(), 0);
+	if (index_map_ != NULL) {
+		for (int gene = 0; gene < CellCount(); gene++) {
+			int count = 0;
+			const int* pixels = index_map_->getGenePixels(gene, count);
+			for (int k = 0; k < count; k++) {
+				center_x[gene] += (pixels[k] % output_image_width_) + 0.5;
+				center_y[gene] += (pixels[k] / output_image_width_) + 0.5;
+			}
+			center_x[gene] /= max(count, 1);
+			center_y[gene] /= max(count, 1);
+		}
+	}
+	else if (IsReady()) {
+		const int top = top_remainder_y_ / output_image_width_;
+		for (int bin = 0; bin < CellCount(); bin++) {
+			center_x[bin] = left_remainder_x_ + ((bin % used_bins_x_) + 0.5) * bin_size_x_;
+			center_y[bin] = top + ((bin / used_bins_x_) + 0.5) * bin_size_y_;
+		}
+	}
 }
 
 // Gets the total number of bins
 int ImageScaler::GetTotalBinNum() {
+	if (modal_basis_ != NULL) {
+		return modal_basis_->getModeCount();
+	}
+	return CellCount();
+}
+
+int ImageScaler::CellCount() const {
+	if (index_map_ != NULL) {
+		return index_map_->getGeneCount();
+	}
 	return used_bins_x_ * used_bins_y_;
 }
 
+bool ImageScaler::IsReady() const {
+	return index_map_ != NULL || (requirement_set_bin_size_ && requirement_set_used_bins_);
+}
+
 // Puts a value of zero into every bin in an image
 // Input: output_image - the image to be zeroed
 // Output: output_image is filled with 0's
@@ -70,39 +164,332 @@ void ImageScaler::ZeroOutputImage(unsigned char* output_image) {
 	}
 }
 
+// Fill count pixels of Depth bytes with pixel, where room bytes from out may be written (room >= count * Depth)
+// Whole vectors are stored, spilling into the following pixels while there is room (they are written after this),
+// a bin wider than a vector ends with a store aligned to its end
+template <int Depth>
+static inline void FillPixels(unsigned char* out, int count, unsigned int pixel, int room) {
+	const int bytes = count * Depth;
+#if defined(IMAGE_SCALER_AVX2)
+	const int vector_bytes = 32;
+	const __m256i value = (Depth == 1) ? _mm256_set1_epi8(char(pixel)) : _mm256_set1_epi16(short(pixel));
+	if (bytes >= vector_bytes || room >= vector_bytes) {
+		int i = 0;
+		for (; i + vector_bytes <= bytes; i += vector_bytes) {
+			_mm256_storeu_si256((__m256i*)(out + i), value);
+		}
+		if (i < bytes) {
+			_mm256_storeu_si256((__m256i*)(out + ((bytes >= vector_bytes) ? bytes - vector_bytes : i)), value);
+		}
+		return;
+	}
+#elif defined(IMAGE_SCALER_SSE2)
+	const int vector_bytes = 16;
+	const __m128i value = (Depth == 1) ? _mm_set1_epi8(char(pixel)) : _mm_set1_epi16(short(pixel));
+	if (bytes >= vector_bytes || room >= vector_bytes) {
+		int i = 0;
+		for (; i + vector_bytes <= bytes; i += vector_bytes) {
+			_mm_storeu_si128((__m128i*)(out + i), value);
+		}
+		if (i < bytes) {
+			_mm_storeu_si128((__m128i*)(out + ((bytes >= vector_bytes) ? bytes - vector_bytes : i)), value);
+		}
+		return;
+	}
+#endif
+	// Last bins of a row (no room to spill) and the scalar path
+	for (int i = 0; i < bytes; i += Depth) {
+		out[i] = (unsigned char)pixel;
+		if (Depth > 1) {
+			out[i + 1] = (unsigned char)(pixel >> 8);
+		}
+	}
+}
+
+// Expand one row of bins into its first scanline, then copy that scanline to the rest of the bin row
+template <int Depth, class T>
+void ImageScaler::TranslateDepth(const T* input_image, unsigned char* output_image) {
+	const size_t scanline_bytes = size_t(output_image_width_) * Depth;
+	const int row_bytes = used_bins_x_ * bin_size_x_ * Depth; // Bytes of a scanline covered by bins
+	unsigned char* line = output_image + size_t(top_remainder_y_ + left_remainder_x_) * Depth;
+	// With a phase correction the phase levels of a row of bins are expanded into phase_line,
+	// and each line of the bins is written corrected from it instead of copied
+	const PhaseCorrection* correction = (Depth == 1) ? phase_correction_.get() : NULL;
+	std::vector<unsigned char> phase_line((correction != NULL) ? output_image_width_ : 0);
+	size_t pixel_index = size_t(top_remainder_y_ + left_remainder_x_);
+	for (int i = 0; i < used_bins_y_; i++) {
+		// for each row of bins
+		const T* bins = input_image + (i * used_bins_x_);
+		unsigned char* phases = (correction != NULL) ? phase_line.data() : line;
+		for (int j = 0; j < used_bins_x_; j++) {
+			// for each bin in the row
+			const unsigned int pixel = BinPixel(bins[j]);
+			const int offset = j * bin_size_x_ * Depth;
+			FillPixels<Depth>(phases + offset, bin_size_x_, pixel, row_bytes - offset);
+		}
+		for (int k = (correction != NULL) ? 0 : 1; k < bin_size_y_; k++) {
+			// for each other line of the bins (each line when correcting)
+			if (correction != NULL) {
+				correction->apply(phases, output_image, pixel_index + k * output_image_width_, row_bytes);
+			}
+			else {
+				memcpy(line + k * scanline_bytes, line, row_bytes);
+			}
+		}
+		line += bin_size_y_ * scanline_bytes;
+		pixel_index += size_t(bin_size_y_) * output_image_width_;
+	}
+}
+
+// The rows above and below the used bins and the columns left and right of them
+void ImageScaler::FillIdle(unsigned char* output_image) {
+	const int top = top_remainder_y_ / output_image_width_;
+	const int used_width = used_bins_x_ * bin_size_x_, used_height = used_bins_y_ * bin_size_y_;
+	const size_t width = size_t(output_image_width_);
+	phase_correction_->fillIdle(output_image, 0, top * width);
+	for (int y = top; y < top + used_height; y++) {
+		phase_correction_->fillIdle(output_image, y * width, left_remainder_x_);
+		phase_correction_->fillIdle(output_image, y * width + left_remainder_x_ + used_width, width - left_remainder_x_ - used_width);
+	}
+	phase_correction_->fillIdle(output_image, (top + used_height) * width, (output_image_height_ - top - used_height) * width);
+}
+
+// Look up the pixel value of each pixel's gene in pixel_table (indices are offset by one so undriven pixels read entry 0)
+// AVX2 gathers 8 pixels at a time and packs them down to the output depth, other paths look up one pixel at a time
+template <int Depth>
+void ImageScaler::GatherDepth(const unsigned int* pixel_table, unsigned char* output_image) {
+	const int32_t* indices = index_map_->getIndices();
+	const int* table = reinterpret_cast<const int*>(pixel_table);
+	const int pixels = output_image_width_ * output_image_height_;
+	int p = 0;
+#if defined(IMAGE_SCALER_AVX2)
+	const __m256i one = _mm256_set1_epi32(1);
+	const int* entries = table; // Gather bases at entry 0 so the offset indexes are used as they are
+	if (Depth == 1) {
+		// 32 pixels, 4 gathers packed to bytes (packs work within 128 bit lanes, the permute puts the dwords back in order)
+		const __m256i order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+		for (; p + 32 <= pixels; p += 32) {
+			const __m256i a = _mm256_i32gather_epi32(entries, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(indices + p)), one), 4);
+			const __m256i b = _mm256_i32gather_epi32(entries, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(indices + p + 8)), one), 4);
+			const __m256i c = _mm256_i32gather_epi32(entries, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(indices + p + 16)), one), 4);
+			const __m256i d = _mm256_i32gather_epi32(entries, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(indices + p + 24)), one), 4);
+			const __m256i bytes = _mm256_packus_epi16(_mm256_packus_epi32(a, b), _mm256_packus_epi32(c, d));
+			_mm256_storeu_si256((__m256i*)(output_image + p), _mm256_permutevar8x32_epi32(bytes, order));
+		}
+	}
+	else if (Depth == 2) {
+		// 16 pixels, 2 gathers packed to 16 bit values
+		for (; p + 16 <= pixels; p += 16) {
+			const __m256i a = _mm256_i32gather_epi32(entries, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(indices + p)), one), 4);
+			const __m256i b = _mm256_i32gather_epi32(entries, _mm256_add_epi32(_mm256_loadu_si256((const __m256i*)(indices + p + 8)), one), 4);
+			_mm256_storeu_si256((__m256i*)(output_image + p * 2), _mm256_permute4x64_epi64(_mm256_packus_epi32(a, b), 0xD8));
+		}
+	}
+#endif
+	for (; p < pixels; p++) {
+		const unsigned int pixel = (unsigned int)table[indices[p] + 1];
+		output_image[p * Depth] = (unsigned char)pixel;
+		if (Depth > 1) {
+			output_image[(p * Depth) + 1] = (unsigned char)(pixel >> 8);
+		}
+	}
+}
+
 // Takes an array holding values for each bin and fills an image with those values
 // Implicit sizes are according to the construction of the scaler
-// Input: input_image - the array holding all the bin values
+// For a depth 1 output a 16 bit gene writes its high byte, for depth 2 the low byte then the high byte
+// Input: input_image - the array holding all the bin values (or mode coefficients with a modal basis)
 //		 output_image - the array to store the output image (already allocated)
 // Output: output_image stores the results
-void ImageScaler::TranslateImage(int* input_image, unsigned char* output_image) {
-	if (requirement_set_bin_size_ && requirement_set_used_bins_)
+template <class T>
+void ImageScaler::TranslateImage(const T* input_image, unsigned char* output_image) {
+	if (IsReady()) {
+		std::vector<int> storage;
+		TranslateCells(CellValues(input_image, storage), output_image);
+	}
+}
+
+template <class T>
+const T* ImageScaler::CellValues(const T* input_image, std::vector<int>& storage) const {
+	if (modal_basis_ == NULL) {
+		return input_image;
+	}
+	storage.resize(CellCount());
+	T* cells = reinterpret_cast<T*>(storage.data());
+	modal_basis_->render(input_image, cells);
+	return cells;
+}
+
+template <class T>
+void ImageScaler::TranslateCells(const T* input_image, unsigned char* output_image) {
+	if (index_map_ != NULL) {
+		// Pixel value of each gene, then a lookup per pixel
+		// Values are cut to the bytes written as the bins do (the vector packs would saturate them instead)
+		// The table is local so frames can be rendered from several threads at once
+		const unsigned int mask = (output_image_depth_ == 1) ? 0xFFu : 0xFFFFu;
+		std::vector<unsigned int> table(CellCount() + 1, 0);
+		for (int bin = 0; bin < CellCount(); bin++) {
+			table[bin + 1] = BinPixel(input_image[bin]) & mask;
+		}
+		if (output_image_depth_ == 1) {
+			GatherDepth<1>(table.data(), output_image);
+			if (phase_correction_ != NULL) {
+				// Undriven pixels were gathered as phase 0, so they are corrected like the rest
+				phase_correction_->apply(output_image, output_image, 0, size_t(output_image_width_) * output_image_height_);
+			}
+		}
+		else if (output_image_depth_ == 2) {
+			GatherDepth<2>(table.data(), output_image);
+		}
+		else {
+			ZeroOutputImage(output_image);
+			for (int bin = 0; bin < CellCount(); bin++) {
+				RenderBin(bin, table[bin + 1], output_image);
+			}
+		}
+	}
+	else if (requirement_set_bin_size_ && requirement_set_used_bins_)
 	{	// prevent action if all steps to set up image scaling have not been completed
-		int start_point = top_remainder_y_ + left_remainder_x_;
-		for (int i = 0; i < used_bins_y_; i++)
-		{	// for each row
-			int line_start_point = start_point + (i*(bin_size_y_*output_image_width_));
-			for (int j = 0; j < used_bins_x_; j++)
-			{	// for each bin in the row
-				int bin_start_point = line_start_point + (j * bin_size_x_);
-				int pix_value;
-
-				pix_value = (input_image[(i * used_bins_x_) + j]);
-
-				for (int k = 0; k < bin_size_y_; k++)
-				{	// for each line in each bin
-					int write_start_point = bin_start_point + (k * output_image_width_);
-					for (int l = 0; l < bin_size_x_; l++)
-					{	// for each space in each line
-						int write_point = write_start_point + l;
-						output_image[write_point*output_image_depth_] = (unsigned char)pix_value;
-						if (output_image_depth_ > 1)
-						{
-							output_image[(write_point*output_image_depth_) + 1] = (pix_value >> 8);
-						}
-					}
-				}
+		if (output_image_depth_ == 1) {
+			TranslateDepth<1>(input_image, output_image);
+			if (phase_correction_ != NULL) {
+				FillIdle(output_image);
+			}
+		}
+		else if (output_image_depth_ == 2) {
+			TranslateDepth<2>(input_image, output_image);
+		}
+		else {
+			for (int bin = 0; bin < CellCount(); bin++) {
+				RenderBin(bin, BinPixel(input_image[bin]), output_image);
+			}
+		}
+	}
+}
+
+// Render all cells and remember output_image as the frame the incremental updates work on
+template <class T>
+void ImageScaler::RenderTracked(const T* cells, unsigned char* output_image) {
+	TranslateCells(cells, output_image);
+	rendered_pixels_.resize(CellCount());
+	for (int bin = 0; bin < CellCount(); bin++) {
+		rendered_pixels_[bin] = BinPixel(cells[bin]);
+	}
+	rendered_frame_ = output_image;
+}
+
+template <class T>
+unsigned int ImageScaler::BinPixel(T gene) const {
+	return (unsigned int)((output_image_depth_ == 1) ? (int(gene) >> GenomeTraits<T>::depth1_shift) : int(gene));
+}
+
+// Fill the rows of a bin (or the pixels of a gene of the index map), without spilling into its neighbours (which are not written)
+void ImageScaler::RenderBin(int bin, unsigned int pixel, unsigned char* output_image) {
+	if (index_map_ != NULL) {
+		// The pixels of the gene
+		int count = 0;
+		const int* pixels = index_map_->getGenePixels(bin, count);
+		for (int k = 0; k < count; k++) {
+			unsigned char* out = output_image + size_t(pixels[k]) * output_image_depth_;
+			out[0] = (phase_correction_ != NULL) ? phase_correction_->correct(pixels[k], pixel) : (unsigned char)pixel;
+			if (output_image_depth_ > 1) {
+				out[1] = (unsigned char)(pixel >> 8);
+			}
+		}
+		return;
+	}
+	const int i = bin / used_bins_x_, j = bin % used_bins_x_;
+	unsigned char* line = output_image + size_t(top_remainder_y_ + left_remainder_x_ + (i * bin_size_y_ * output_image_width_) + (j * bin_size_x_)) * output_image_depth_;
+	const size_t scanline_bytes = size_t(output_image_width_) * output_image_depth_;
+	for (int k = 0; k < bin_size_y_; k++, line += scanline_bytes) {
+		// for each line in the bin
+		if (output_image_depth_ == 1) {
+			FillPixels<1>(line, bin_size_x_, pixel, bin_size_x_);
+			if (phase_correction_ != NULL) {
+				phase_correction_->apply(line, output_image, line - output_image, bin_size_x_);
 			}
 		}
+		else if (output_image_depth_ == 2) {
+			FillPixels<2>(line, bin_size_x_, pixel, bin_size_x_ * 2);
+		}
+		else {
+			// Other depths only have their first two bytes written
+			for (int l = 0; l < bin_size_x_; l++) {
+				line[l * output_image_depth_] = (unsigned char)pixel;
+				line[(l * output_image_depth_) + 1] = (unsigned char)(pixel >> 8);
+			}
+		}
+	}
+}
+
+// Re-render only the bins that differ from the last render of output_image
+// Input: input_image - the array holding all the bin values
+//		 output_image - the array to store the output image (already allocated)
+// Output: output_image stores the results, returns the number of bins written
+template <class T>
+int ImageScaler::TranslateChanged(const T* input_image, unsigned char* output_image) {
+	if (!IsReady()) {
+		return 0;
+	}
+	std::vector<int> storage;
+	const T* cells = CellValues(input_image, storage);
+	if (output_image != rendered_frame_) {
+		RenderTracked(cells, output_image);
+		return CellCount();
+	}
+	int written = 0;
+	for (int bin = 0; bin < CellCount(); bin++) {
+		const unsigned int pixel = BinPixel(cells[bin]);
+		if (pixel != rendered_pixels_[bin]) {
+			RenderBin(bin, pixel, output_image);
+			rendered_pixels_[bin] = pixel;
+			written++;
+		}
 	}
+	return written;
 }
+
+// Re-render the listed bins of output_image
+// Input: input_image - the array holding all the bin values
+//		 output_image - the array to store the output image (already allocated)
+//		 bins - indexes of the bins that changed since output_image was rendered (indexes past the used bins are ignored)
+//		 count - number of indexes in bins
+// Output: output_image stores the results
+template <class T>
+void ImageScaler::UpdateBins(const T* input_image, unsigned char* output_image, const int* bins, int count) {
+	if (!IsReady()) {
+		return;
+	}
+	if (modal_basis_ != NULL) {
+		TranslateChanged(input_image, output_image);
+		return;
+	}
+	if (output_image != rendered_frame_) {
+		RenderTracked(input_image, output_image);
+		return;
+	}
+	for (int i = 0; i < count; i++) {
+		if (bins[i] >= 0 && bins[i] < CellCount()) {
+			const unsigned int pixel = BinPixel(input_image[bins[i]]);
+			RenderBin(bins[i], pixel, output_image);
+			rendered_pixels_[bins[i]] = pixel;
+		}
+	}
+}
+
+// Forget the last rendered frame
+void ImageScaler::InvalidateRendered() {
+	rendered_frame_ = NULL;
+	rendered_pixels_.clear();
+}
+
+// Gene types the scaler is used with (int for BruteForce, unsigned char & unsigned short for the genetic algorithms)
+template void ImageScaler::TranslateImage<int>(const int* input_image, unsigned char* output_image);
+template void ImageScaler::TranslateImage<unsigned char>(const unsigned char* input_image, unsigned char* output_image);
+template void ImageScaler::TranslateImage<unsigned short>(const unsigned short* input_image, unsigned char* output_image);
+template int ImageScaler::TranslateChanged<int>(const int* input_image, unsigned char* output_image);
+template int ImageScaler::TranslateChanged<unsigned char>(const unsigned char* input_image, unsigned char* output_image);
+template int ImageScaler::TranslateChanged<unsigned short>(const unsigned short* input_image, unsigned char* output_image);
+template void ImageScaler::UpdateBins<int>(const int* input_image, unsigned char* output_image, const int* bins, int count);
+template void ImageScaler::UpdateBins<unsigned char>(const unsigned char* input_image, unsigned char* output_image, const int* bins, int count);
+template void ImageScaler::UpdateBins<unsigned short>(const unsigned short* input_image, unsigned char* output_image, const int* bins, int count);
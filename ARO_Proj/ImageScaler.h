@@ -5,6 +5,13 @@
 #ifndef IMAGE_SCALER_H_
 #define IMAGE_SCALER_H_
 
+#include <memory>	// std::shared_ptr
+#include <vector>
+
+#include "IndexMap.h"
+#include "ModalBasis.h"
+#include "PhaseCorrection.h"
+
 class ImageScaler {
 private:
 	int output_image_width_, output_image_height_, output_image_depth_;
@@ -14,14 +21,89 @@ private:
 	int remainder_x_, remainder_y_;
 	int left_remainder_x_, top_remainder_y_;
 	bool requirement_set_bin_size_, requirement_set_used_bins_;
+	// Frame last rendered by an incremental update (TranslateChanged() or UpdateBins()) and the pixel value of each of its bins,
+	// so later updates of the same frame only re-render the bins that changed (NULL if there is none)
+	const unsigned char* rendered_frame_;
+	std::vector<unsigned int> rendered_pixels_;
+	// Per pixel gene index used instead of the rectangular bins when set (see SetIndexMap())
+	std::shared_ptr<const IndexMap> index_map_;
+	// Modes the input images are coefficients of when set (see SetModalBasis())
+	std::shared_ptr<const ModalBasis> modal_basis_;
+	// Base phase, wrap and LUT applied to every pixel written when set (see SetPhaseCorrection())
+	std::shared_ptr<const PhaseCorrection> phase_correction_;
+
+	// True once the bins are set up (bin size and used bins, or an index map)
+	bool IsReady() const;
+	// Number of cells of the output image (used bins, or genes of the index map)
+	int CellCount() const;
+	// Value of each cell for an input image, the input itself or the cells rendered from its mode coefficients
+	// Input: storage - holds the rendered cells (an int per cell, room for the largest gene type), kept by the caller while they are used
+	template <class T>
+	const T* CellValues(const T* input_image, std::vector<int>& storage) const;
+	// TranslateImage() of cell values
+	template <class T>
+	void TranslateCells(const T* input_image, unsigned char* output_image);
+	// TranslateCells(), then remember output_image as the rendered frame for the incremental updates
+	template <class T>
+	void RenderTracked(const T* cells, unsigned char* output_image);
+	// Write the corrected zero phase to the pixels outside the used bins
+	void FillIdle(unsigned char* output_image);
+
+	// TranslateImage() for an output of Depth bytes per pixel (1 and 2 are the SLM formats)
+	template <int Depth, class T>
+	void TranslateDepth(const T* input_image, unsigned char* output_image);
+	// TranslateImage() with an index map, looking up the pixel value of each pixel's gene
+	// Input: pixel_table - pixel value of each gene of the map, entry 0 is for pixels no gene drives (index -1)
+	template <int Depth>
+	void GatherDepth(const unsigned int* pixel_table, unsigned char* output_image);
+	// Value written to the pixels of a bin for a gene (a depth 1 output gets its 8 bit value, deeper outputs the low byte then the high byte)
+	template <class T>
+	unsigned int BinPixel(T gene) const;
+	// Fill the pixels of one bin
+	// Input: bin - bin index (as in the input image), pixel - value from BinPixel(), output_image - the frame
+	void RenderBin(int bin, unsigned int pixel, unsigned char* output_image);
 public:
 	ImageScaler(int output_image_width, int output_image_height, int output_image_depth);
 
 	void SetBinSize(int bin_size_x, int bin_size_y);
 	void GetMaxBins(int &max_bins_x, int &max_bins_y);
 	void SetUsedBins(int used_bins_x, int used_bins_y);
+	// Use a per pixel gene index instead of the rectangular bins (hexagonal cells, a pupil, a map from a file...)
+	// Each gene of the input image is then a gene of the map, pixels no gene drives are written 0
+	// Input: index_map - the map, of the same width and height as the output image (NULL to go back to the rectangular bins)
+	// Output: false if the map does not fit the output image (the scaler is unchanged)
+	bool SetIndexMap(std::shared_ptr<const IndexMap> index_map);
+	// Take input images as coefficients of modes sampled at the cells (set after the bins or index map, which give the cells)
+	// Input: modal_basis - the modes, with a value for each cell (NULL to go back to a gene per cell)
+	// Output: false if the basis does not have the cells of this scaler (the scaler is unchanged)
+	bool SetModalBasis(std::shared_ptr<const ModalBasis> modal_basis);
+	// Correct every pixel written (base phase, wrap and software LUT) in the same pass that writes it, for depth 1 outputs
+	// Input: phase_correction - the stage, of the same width and height as the output image (NULL, or one that changes nothing, for none)
+	// Output: false if the stage does not fit the output image (the scaler is unchanged)
+	bool SetPhaseCorrection(std::shared_ptr<const PhaseCorrection> phase_correction);
+	// Position in pixels of the center of each cell (bin center, or centroid of the pixels of an index map gene)
+	void GetCellCenters(std::vector<double> &center_x, std::vector<double> &center_y);
+	// Number of genes an input image holds (used bins, genes of the index map or modes of the basis)
 	int GetTotalBinNum();
-	void TranslateImage(int* input_image, unsigned char* output_image);
+	// Fill output_image with the bin values of input_image, T is the gene type (see GenomeTraits.h)
+	// Does not change the frame remembered by the incremental updates, rendering into that frame with it requires InvalidateRendered()
+	// Keeps no state in the scaler, so one scaler may render different frames from several threads at once
+	// Defined in ImageScaler.cpp for int, unsigned char and unsigned short
+	template <class T>
+	void TranslateImage(const T* input_image, unsigned char* output_image);
+	// Same result as TranslateImage(), but if output_image holds the frame this scaler last rendered only the bins whose value changed are written
+	// output_image must not have been changed by anything else since (InvalidateRendered() otherwise)
+	// Not to be called from several threads at once (the rendered frame is state of the scaler)
+	// Output: number of bins written
+	template <class T>
+	int TranslateChanged(const T* input_image, unsigned char* output_image);
+	// Write only the listed bins of input_image into the frame this scaler last rendered to output_image (all bins if it holds another frame)
+	// With a modal basis every cell may change with any mode, so this is TranslateChanged()
+	// Input: bins - indexes of the bins that may have changed since the last render, count - number of them
+	template <class T>
+	void UpdateBins(const T* input_image, unsigned char* output_image, const int* bins, int count);
+	// Forget the last rendered frame (the next update renders all bins)
+	void InvalidateRendered();
 	void ZeroOutputImage(unsigned char* output_image);
 };
 
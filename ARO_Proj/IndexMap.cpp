@@ -0,0 +1,241 @@
+////////////////////
+// IndexMap.cpp - implementation of IndexMap class
+////////////////////
+
+#include "stdafx.h"
+#include "IndexMap.h"
+#include "Utility.h"
+
+#include <algorithm> // std::min & std::max
+#include <cmath>	 // std::floor & std::sqrt
+#include <cstdio>	 // EOF
+#include <cstring>	 // memcmp()
+#include <fstream>	 // reading and writing map files
+
+static const char mapMagic[8] = { 'A', 'R', 'O', 'I', 'M', 'A', 'P', '1' };
+static const size_t mapHeaderBytes = sizeof(mapMagic) + 3 * sizeof(int32_t);
+
+IndexMap::IndexMap(int width, int height) {
+	this->width_ = width;
+	this->height_ = height;
+	this->gene_count_ = 0;
+	this->indices_ = NULL;
+	this->file_ = NULL;
+	this->mapping_ = NULL;
+	this->view_ = NULL;
+}
+
+IndexMap::~IndexMap() {
+#ifdef _WIN32
+	if (this->view_ != NULL) {
+		UnmapViewOfFile(this->view_);
+	}
+	if (this->mapping_ != NULL) {
+		CloseHandle(this->mapping_);
+	}
+	if (this->file_ != NULL) {
+		CloseHandle(this->file_);
+	}
+#endif
+}
+
+// Counting sort of the pixels by gene
+bool IndexMap::buildGenePixels() {
+	const size_t pixels = size_t(this->width_) * this->height_;
+	this->gene_offsets_.assign(this->gene_count_ + 1, 0);
+	for (size_t p = 0; p < pixels; p++) {
+		const int32_t gene = this->indices_[p];
+		if (gene < -1 || gene >= this->gene_count_) {
+			return false;
+		}
+		if (gene >= 0) {
+			this->gene_offsets_[gene + 1]++;
+		}
+	}
+	for (int g = 0; g < this->gene_count_; g++) {
+		this->gene_offsets_[g + 1] += this->gene_offsets_[g];
+	}
+	this->gene_pixels_.resize(this->gene_offsets_[this->gene_count_]);
+	std::vector<int> next(this->gene_offsets_.begin(), this->gene_offsets_.end() - 1);
+	for (size_t p = 0; p < pixels; p++) {
+		if (this->indices_[p] >= 0) {
+			this->gene_pixels_[next[this->indices_[p]]++] = int(p);
+		}
+	}
+	return true;
+}
+
+void IndexMap::renumber(int cellCount) {
+	std::vector<int32_t> gene(cellCount, -1);
+	this->gene_count_ = 0;
+	for (size_t p = 0; p < this->owned_.size(); p++) {
+		const int32_t cell = this->owned_[p];
+		if (cell >= 0) {
+			if (gene[cell] < 0) {
+				gene[cell] = this->gene_count_++;
+			}
+			this->owned_[p] = gene[cell];
+		}
+	}
+}
+
+void IndexMap::maskPupil(double pupilRadius) {
+	if (pupilRadius <= 0) {
+		return;
+	}
+	const double centerX = this->width_ / 2.0, centerY = this->height_ / 2.0;
+	for (int y = 0; y < this->height_; y++) {
+		const double dy = y + 0.5 - centerY;
+		for (int x = 0; x < this->width_; x++) {
+			const double dx = x + 0.5 - centerX;
+			if (dx * dx + dy * dy > pupilRadius * pupilRadius) {
+				this->owned_[size_t(y) * this->width_ + x] = -1;
+			}
+		}
+	}
+}
+
+std::shared_ptr<IndexMap> IndexMap::rectangular(int width, int height, int binSizeX, int binSizeY, int usedBinsX, int usedBinsY, double pupilRadius) {
+	if (width <= 0 || height <= 0 || binSizeX <= 0 || binSizeY <= 0) {
+		return NULL;
+	}
+	std::shared_ptr<IndexMap> map(new IndexMap(width, height));
+	// Same placement as ImageScaler::SetUsedBins(), the unused width and height split around the used bins
+	usedBinsX = (std::max)(0, (std::min)(usedBinsX, width / binSizeX));
+	usedBinsY = (std::max)(0, (std::min)(usedBinsY, height / binSizeY));
+	const int left = (width - usedBinsX * binSizeX) / 2;
+	const int top = (height - usedBinsY * binSizeY) / 2;
+
+	map->owned_.assign(size_t(width) * height, -1);
+	for (int y = 0; y < usedBinsY * binSizeY; y++) {
+		int32_t * row = map->owned_.data() + size_t(top + y) * width + left;
+		for (int x = 0; x < usedBinsX * binSizeX; x++) {
+			row[x] = (y / binSizeY) * usedBinsX + (x / binSizeX);
+		}
+	}
+	map->maskPupil(pupilRadius);
+	map->renumber(usedBinsX * usedBinsY);
+	map->indices_ = map->owned_.data();
+	if (map->gene_count_ == 0 || !map->buildGenePixels()) {
+		return NULL;
+	}
+	return map;
+}
+
+std::shared_ptr<IndexMap> IndexMap::hexagonal(int width, int height, double pitch, double pupilRadius) {
+	if (width <= 0 || height <= 0 || pitch < 1) {
+		return NULL;
+	}
+	std::shared_ptr<IndexMap> map(new IndexMap(width, height));
+	// A cell is centered on the image center, rows of cells are rowPitch apart and every other row is shifted by half a pitch
+	const double rowPitch = pitch * std::sqrt(3.0) / 2;
+	const double centerX = width / 2.0, centerY = height / 2.0;
+	const int firstRow = int(std::floor(-centerY / rowPitch)) - 1, lastRow = int(std::floor(centerY / rowPitch)) + 2;
+	const int firstColumn = int(std::floor(-centerX / pitch)) - 1, lastColumn = int(std::floor(centerX / pitch)) + 2;
+	const int columns = lastColumn - firstColumn + 1;
+
+	map->owned_.assign(size_t(width) * height, -1);
+	for (int y = 0; y < height; y++) {
+		const double py = y + 0.5 - centerY;
+		// The nearest center is in one of the two rows around the pixel, as a cell reaches pitch / sqrt(3) < rowPitch from its center
+		const int below = int(std::floor(py / rowPitch));
+		for (int x = 0; x < width; x++) {
+			const double px = x + 0.5 - centerX;
+			double nearest = -1;
+			int32_t cell = -1;
+			for (int row = below; row <= below + 1; row++) {
+				const double shift = (row & 1) ? pitch / 2 : 0;
+				const int column = int(std::floor((px - shift) / pitch + 0.5));
+				const double dx = px - (column * pitch + shift), dy = py - row * rowPitch;
+				const double distance = dx * dx + dy * dy;
+				if (cell < 0 || distance < nearest) {
+					nearest = distance;
+					cell = (row - firstRow) * columns + (column - firstColumn);
+				}
+			}
+			map->owned_[size_t(y) * width + x] = cell;
+		}
+	}
+	map->maskPupil(pupilRadius);
+	map->renumber((lastRow - firstRow + 1) * columns);
+	map->indices_ = map->owned_.data();
+	if (map->gene_count_ == 0 || !map->buildGenePixels()) {
+		return NULL;
+	}
+	return map;
+}
+
+std::shared_ptr<IndexMap> IndexMap::load(const std::string & path) {
+	int32_t header[3];
+	std::shared_ptr<IndexMap> map;
+#ifdef _WIN32
+	// Map the file read only, the indices are used where they are
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (file == INVALID_HANDLE_VALUE) {
+		Utility::printLine("ERROR: could not open index map file " + path);
+		return NULL;
+	}
+	LARGE_INTEGER fileBytes;
+	HANDLE mapping = NULL;
+	const unsigned char * view = NULL;
+	if (GetFileSizeEx(file, &fileBytes) && size_t(fileBytes.QuadPart) >= mapHeaderBytes) {
+		mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+	}
+	if (mapping != NULL) {
+		view = static_cast<const unsigned char*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0));
+	}
+	if (view == NULL) {
+		Utility::printLine("ERROR: could not map index map file " + path);
+		if (mapping != NULL) {
+			CloseHandle(mapping);
+		}
+		CloseHandle(file);
+		return NULL;
+	}
+	memcpy(header, view + sizeof(mapMagic), sizeof(header));
+	map.reset(new IndexMap(header[0], header[1]));
+	map->file_ = file;
+	map->mapping_ = mapping;
+	map->view_ = view;
+	map->gene_count_ = header[2];
+	if (memcmp(view, mapMagic, sizeof(mapMagic)) != 0 || header[0] <= 0 || header[1] <= 0 || header[2] <= 0
+		|| size_t(fileBytes.QuadPart) != mapHeaderBytes + size_t(header[0]) * header[1] * sizeof(int32_t)) {
+		Utility::printLine("ERROR: " + path + " is not a valid index map file");
+		return NULL;
+	}
+	map->indices_ = reinterpret_cast<const int32_t*>(view + mapHeaderBytes);
+#else
+	std::ifstream file(path, std::ios::binary);
+	char magic[sizeof(mapMagic)];
+	if (!file.read(magic, sizeof(magic)) || !file.read(reinterpret_cast<char*>(header), sizeof(header))) {
+		Utility::printLine("ERROR: could not read index map file " + path);
+		return NULL;
+	}
+	if (memcmp(magic, mapMagic, sizeof(mapMagic)) != 0 || header[0] <= 0 || header[1] <= 0 || header[2] <= 0) {
+		Utility::printLine("ERROR: " + path + " is not a valid index map file");
+		return NULL;
+	}
+	map.reset(new IndexMap(header[0], header[1]));
+	map->gene_count_ = header[2];
+	map->owned_.resize(size_t(header[0]) * header[1]);
+	if (!file.read(reinterpret_cast<char*>(map->owned_.data()), map->owned_.size() * sizeof(int32_t)) || file.peek() != EOF) {
+		Utility::printLine("ERROR: " + path + " is not a valid index map file");
+		return NULL;
+	}
+	map->indices_ = map->owned_.data();
+#endif
+	if (!map->buildGenePixels()) {
+		Utility::printLine("ERROR: index map file " + path + " has gene indexes out of range");
+		return NULL;
+	}
+	return map;
+}
+
+bool IndexMap::save(const std::string & path) const {
+	std::ofstream file(path, std::ios::binary | std::ios::trunc);
+	const int32_t header[3] = { this->width_, this->height_, this->gene_count_ };
+	file.write(mapMagic, sizeof(mapMagic));
+	file.write(reinterpret_cast<const char*>(header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(this->indices_), size_t(this->width_) * this->height_ * sizeof(int32_t));
+	return bool(file);
+}
@@ -0,0 +1,99 @@
+////////////////////
+// IndexMap.h - per pixel gene index of an SLM image, for segmentations other than the uniform rectangular bins of ImageScaler
+////////////////////
+
+#ifndef INDEX_MAP_H_
+#define INDEX_MAP_H_
+
+#include <cstdint>
+#include <memory>	// std::shared_ptr
+#include <string>
+#include <vector>
+
+// Which gene drives each pixel of an SLM image (row major, -1 for pixels no gene drives, such as dead regions or outside the pupil)
+// Built once per run by one of the factories, or loaded from a file (memory mapped, so large maps cost nothing to open).
+// The pixels of each gene are also listed, for rendering only the genes that changed.
+//
+// File format (little endian): 8 byte magic "AROIMAP1", int32 width, height and gene count, then width * height int32 indices
+class IndexMap {
+private:
+	int width_, height_, gene_count_;
+	std::vector<int32_t> owned_;	// Indices when built or read, empty when mapped
+	const int32_t * indices_;		// Index of each pixel (owned_ or the mapped file)
+	void * file_;					// Handles of a mapped file (NULL if not mapped)
+	void * mapping_;
+	const void * view_;
+	// Pixels of each gene, gene g has gene_pixels_[gene_offsets_[g]] to gene_pixels_[gene_offsets_[g + 1] - 1]
+	std::vector<int> gene_offsets_;
+	std::vector<int> gene_pixels_;
+
+	IndexMap(int width, int height);
+	// Check every index is in [-1, gene count) and list the pixels of each gene
+	// Output: false if an index is out of range
+	bool buildGenePixels();
+	// Turn the cell of each pixel in owned_ into a gene index, numbering the cells in order of their first pixel
+	// Input: cellCount - cells are 0 to cellCount - 1 (-1 for undriven pixels)
+	void renumber(int cellCount);
+	// Set pixels whose center is further than pupilRadius from the image center to -1 (nothing if pupilRadius <= 0)
+	void maskPupil(double pupilRadius);
+
+public:
+	~IndexMap();
+	IndexMap(const IndexMap & other) = delete;
+	IndexMap& operator=(const IndexMap & other) = delete;
+
+	// Uniform rectangular bins laid out as ImageScaler does (used bins centered), optionally only those within a pupil
+	// Input:
+	//	width, height - SLM image size in pixels
+	//	binSizeX, binSizeY - bin size in pixels
+	//	usedBinsX, usedBinsY - number of bins in each direction (limited to what fits)
+	//	pupilRadius - pixels further than this from the image center are not driven and bins left without pixels get no gene (pixels, 0 for no pupil)
+	// Output: the map, NULL if there would be no genes
+	static std::shared_ptr<IndexMap> rectangular(int width, int height, int binSizeX, int binSizeY, int usedBinsX, int usedBinsY, double pupilRadius = 0);
+
+	// Hexagonal cells (rows of cells offset by half a cell), each pixel belongs to the nearest cell center
+	// Input:
+	//	width, height - SLM image size in pixels
+	//	pitch - distance between neighbouring cell centers in pixels
+	//	pupilRadius - pixels further than this from the image center are not driven and cells left without pixels get no gene (pixels, 0 for no pupil)
+	// Output: the map, NULL if there would be no genes
+	static std::shared_ptr<IndexMap> hexagonal(int width, int height, double pitch, double pupilRadius = 0);
+
+	// Open a map file (memory mapped on Windows)
+	// Input: path - the file
+	// Output: the map, NULL if the file could not be read or is invalid (reason printed)
+	static std::shared_ptr<IndexMap> load(const std::string & path);
+
+	// Write the map to a file that load() can open
+	// Output: false if the file could not be written
+	bool save(const std::string & path) const;
+
+	const int getWidth() const {
+		return this->width_;
+	}
+
+	const int getHeight() const {
+		return this->height_;
+	}
+
+	// Number of genes (the genome length for this map)
+	const int getGeneCount() const {
+		return this->gene_count_;
+	}
+
+	// Gene index of every pixel, row major (-1 for undriven pixels)
+	const int32_t * getIndices() const {
+		return this->indices_;
+	}
+
+	// Pixels (index into the image) driven by a gene
+	// Input: gene - gene index
+	//		  count - set to the number of pixels
+	// Output: the first of them
+	const int * getGenePixels(int gene, int & count) const {
+		count = this->gene_offsets_[gene + 1] - this->gene_offsets_[gene];
+		return this->gene_pixels_.data() + this->gene_offsets_[gene];
+	}
+};
+
+#endif
@@ -10,6 +10,7 @@
 template <class T>
 struct Individual {
 	// The genome associated with the individual.
+	// This is a view into storage owned by the population (GenomeArena), the individual never deletes it
 	T * genome_;
 
 	// The fitness of the individual, this must be assigned with set_fitness
@@ -22,13 +23,6 @@ struct Individual {
 		this->fitness_ = -1;
 	}
 
-	// Destructor
-	~Individual() {
-		if (this->genome_ != NULL) {
-			delete[] this->genome_;
-		}
-	}
-
 	// Returns the array(genome) associated with the individual.
 	T * genome() const {
 		return this->genome_;
@@ -40,12 +34,9 @@ struct Individual {
 	}
 
 	// Sets the genome to be associated with the individual.
-	// Input: new_genome - genome to be set to this individual
-	// Output: new_genome is assigned, old genome is deleted
+	// Input: new_genome - genome to be set to this individual (not owned, storage is managed by the population)
+	// Output: new_genome is assigned
 	void set_genome(T * new_genome) {
-		if (this->genome_ != NULL) {
-			delete[] this->genome_;
-		}
 		this->genome_ = new_genome;
 	}
 
@@ -64,17 +55,4 @@ bool operator<(Individual<T> &a, Individual<T> &b) {
 	return a.fitness() < b.fitness();
 }
 
-// Perform a swap of individuals (their pointers are swapped, not a deep copy)
-template <typename T>
-void swapIndividuals(Individual<T> &a, Individual<T> & b) {
-	// Swap fitness
-	double temp_fit = a.fitness();
-	a.set_fitness(b.fitness());
-	b.set_fitness(temp_fit);
-
-	T * temp_ptr = a.genome();
-	a.genome_ = b.genome();
-	b.genome_ = temp_ptr;
-}
-
 #endif
@@ -16,6 +16,7 @@
 // - Aglogrithm Related
 #include "uGA_Optimization.h"
 #include "SGA_Optimization.h"
+#include "SteadyState_Optimization.h"
 #include "BruteForce_Optimization.h"
 
 //	- Helper
@@ -37,6 +38,7 @@ void MainDialog::DoDataExchange(CDataExchange* pDX) {
 	CDialog::DoDataExchange(pDX);
 	DDX_Control(pDX, IDC_UGA_BUTTON, m_uGAButton);
 	DDX_Control(pDX, IDC_SGA_BUTTON, m_SGAButton);
+	DDX_Control(pDX, IDC_SSGA_BUTTON, m_SSGAButton);
 	DDX_Control(pDX, IDC_OPT_BUTTON, m_OptButton);
 	DDX_Control(pDX, IDC_START_STOP_BUTTON, m_StartStopButton);
 	DDX_Control(pDX, IDC_MULTITHREAD_ENABLE, m_MultiThreadEnable);
@@ -52,6 +54,7 @@ BEGIN_MESSAGE_MAP(MainDialog, CDialog)
 	ON_WM_CLOSE()
 	ON_BN_CLICKED(IDC_UGA_BUTTON, &MainDialog::OnBnClickedUgaButton)
 	ON_BN_CLICKED(IDC_SGA_BUTTON, &MainDialog::OnBnClickedSgaButton)
+	ON_BN_CLICKED(IDC_SSGA_BUTTON, &MainDialog::OnBnClickedSsgaButton)
 	ON_BN_CLICKED(IDC_OPT_BUTTON, &MainDialog::OnBnClickedOptButton)
 	ON_NOTIFY(TCN_SELCHANGE, IDC_TAB1, &MainDialog::OnTcnSelchangeTab1)
 	ON_BN_CLICKED(IDC_START_STOP_BUTTON, &MainDialog::OnBnClickedStartStopButton)
@@ -130,6 +133,7 @@ BOOL MainDialog::OnInitDialog() {
 	this->m_mainToolTips->AddTool(GetDlgItem(IDC_MULTITHREAD_ENABLE), L"Enable the usage of multithreading to perform the GAs faster");
 	this->m_mainToolTips->AddTool(GetDlgItem(IDC_SGA_BUTTON), L"Use the Simple Genetic Algorithm");
 	this->m_mainToolTips->AddTool(GetDlgItem(IDC_UGA_BUTTON), L"Use the Micro Genetic Algorithm");
+	this->m_mainToolTips->AddTool(GetDlgItem(IDC_SSGA_BUTTON), L"Use the Steady State Genetic Algorithm (breeds the next child while the current one is measured)");
 	this->m_mainToolTips->AddTool(GetDlgItem(IDC_OPT_BUTTON), L"Use the Brute Force Algorithm (multithreading is not utilized!)");
 	this->m_mainToolTips->AddTool(GetDlgItem(IDC_START_STOP_BUTTON), L"Control start/abort of the algorithm");
 
@@ -325,6 +329,7 @@ void MainDialog::OnBnClickedUgaButton() {
 	// Disabling uGA (now that it's selected) and enabling other options and start button
 	this->m_uGAButton.EnableWindow(false);
 	this->m_SGAButton.EnableWindow(true);
+	this->m_SSGAButton.EnableWindow(true);
 	this->m_OptButton.EnableWindow(true);
 	this->m_StartStopButton.EnableWindow(true);
 }
@@ -336,6 +341,20 @@ void MainDialog::OnBnClickedSgaButton() {
 
 	// Disabling SGA (now that it's selected) and enabling other options and start button
 	this->m_SGAButton.EnableWindow(false);
+	this->m_uGAButton.EnableWindow(true);
+	this->m_SSGAButton.EnableWindow(true);
+	this->m_OptButton.EnableWindow(true);
+	this->m_StartStopButton.EnableWindow(true);
+}
+
+//OnBnClickedSsgaButton: Select the steady state GA Algorithm Button
+void MainDialog::OnBnClickedSsgaButton() {
+	Utility::printLine("INFO: Steady state GA optimization selected");
+	this->opt_selection_ = OptType::SSGA;
+
+	// Disabling SSGA (now that it's selected) and enabling other options and start button
+	this->m_SSGAButton.EnableWindow(false);
+	this->m_SGAButton.EnableWindow(true);
 	this->m_uGAButton.EnableWindow(true);
 	this->m_OptButton.EnableWindow(true);
 	this->m_StartStopButton.EnableWindow(true);
@@ -349,6 +368,7 @@ void MainDialog::OnBnClickedOptButton() {
 	// Disabling BF (now that it's selected) and enabling other options and start button
 	this->m_OptButton.EnableWindow(false);
 	this->m_SGAButton.EnableWindow(true);
+	this->m_SSGAButton.EnableWindow(true);
 	this->m_uGAButton.EnableWindow(true);
 	this->m_StartStopButton.EnableWindow(true);
 }
@@ -397,6 +417,7 @@ void MainDialog::disableMainUI(bool isMainEnabled) {
 	// Reference for directly enabling/disabling items: https://stackoverflow.com/questions/30350537/how-to-check-and-uncheck-and-enable-and-disable-a-check-box-control-in-mfc
 	GetDlgItem(IDC_UGA_BUTTON)->EnableWindow(isMainEnabled);
 	GetDlgItem(IDC_SGA_BUTTON)->EnableWindow(isMainEnabled);
+	GetDlgItem(IDC_SSGA_BUTTON)->EnableWindow(isMainEnabled);
 	GetDlgItem(IDC_OPT_BUTTON)->EnableWindow(isMainEnabled);
 	GetDlgItem(IDC_MULTITHREAD_ENABLE)->EnableWindow(isMainEnabled);
 	GetDlgItem(IDC_SAVE_SETTINGS)->EnableWindow(isMainEnabled);
@@ -467,6 +488,10 @@ UINT __cdecl optThreadMethod(LPVOID instance) {
 		uGA_Optimization opt(dlg, dlg->camCtrl, dlg->slmCtrl);
 		dlg->opt_success = opt.runOptimization();
 	}
+	else if (dlg->opt_selection_ == dlg->OptType::SSGA) {
+		SteadyState_Optimization opt(dlg, dlg->camCtrl, dlg->slmCtrl);
+		dlg->opt_success = opt.runOptimization();
+	}
 	else {
 		Utility::printLine("ERROR: No optimization method selected!");
 		dlg->opt_success = false;
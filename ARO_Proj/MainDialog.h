@@ -83,12 +83,14 @@ public:
 		NONE,
 		IA,
 		SGA,
-		uGA
+		uGA,
+		SSGA
 	};
 	OptType opt_selection_; // Current selected optimization algorithm
 
 	CButton m_uGAButton; // Select uGA button
 	CButton m_SGAButton; // Select SGA button
+	CButton m_SSGAButton; // Select steady state GA button
 	CButton m_OptButton; // Select OPT5 (BruteForce) button
 	CButton m_StartStopButton; // Start selected optimization button (or if opt is running will stop)
 	CButton m_MultiThreadEnable; // If checked, perform the optimizations with multithreading where possible
@@ -100,6 +102,8 @@ public:
 	afx_msg void OnBnClickedUgaButton();
 	//OnBnClickedSgaButton: Select the SGA Algorithm Button
 	afx_msg void OnBnClickedSgaButton();
+	//OnBnClickedSsgaButton: Select the steady state GA Algorithm Button
+	afx_msg void OnBnClickedSsgaButton();
 	//OnBnClickedOptButton: Select the OPT5 Algorithm Button
 	afx_msg void OnBnClickedOptButton();
 	afx_msg void OnBnClickedMultiThreadEnable();
@@ -126,6 +130,45 @@ public:
 	bool running_optimization_;
 	// Store output of optimization thread so that the gui can access it when finished
 	bool opt_success;
+	// Seed for the random number generators of the optimization, 0 seeds randomly (only set through "rngSeed" of a settings file)
+	unsigned long long rngSeed_ = 0;
+	// Chance for each gene of a new individual to mutate in the SGA and steady state populations, in (0, 1] (only set through "mutationRate" of a settings file)
+	double mutationRate_ = 1.0 / 200;
+	// If true the GAs stage each generation in SLM RAM and select frames instead of writing them, once verified on the hardware (only set through "slmFrameBank" of a settings file)
+	bool slmFrameBank_ = false;
+	// If true each measurement waits for a camera frame exposed after the SLM settled (only set through "syncAcquisition" of a settings file)
+	bool syncAcquisition_ = false;
+	// Time for a pattern written to the SLM to settle in microseconds, used when syncAcquisition_ (only set through "slmSettleTime" of a settings file)
+	double slmSettleTime_ = 10000;
+	// If true the GAs reuse the fitness of genomes measured within fitnessCacheTTL_ generations at the same exposure instead of measuring them again
+	// (only set through "useFitnessCache" and "fitnessCacheTTL" of a settings file)
+	bool useFitnessCache_ = true;
+	int fitnessCacheTTL_ = 10;
+	// Fitness function of the optimizations as a FitnessType value, 0 for mean intensity (only set through "fitnessFunction" of a settings file)
+	int fitnessFunction_ = 0;
+	// Target center offset from the camera image center in pixels and its y/x axis ratio (only set through "targetOffsetX", "targetOffsetY" and "targetAspect")
+	double targetOffsetX_ = 0;
+	double targetOffsetY_ = 0;
+	double targetAspect_ = 1;
+	// Spots of the multiple target fitness as "x,y,r,w;x,y,r,w;..." (offset from the image center, radius and weight) and how they are combined as a TargetAggregator value
+	// (only set through "targetSpots" and "targetAggregator" of a settings file)
+	std::string targetSpots_ = "";
+	int targetAggregator_ = 0;
+	// How the GAs divide the SLM into genes, 0 for rectangular bins and 1 for hexagonal cells of binSizeX pitch, with genes only within slmPupilRadius_ pixels
+	// of the SLM center (0 for the whole SLM), or the index map file slmIndexMapFile_ when it is set (only set through "slmSegmentation", "slmPupilRadius" and "slmIndexMapFile")
+	int slmSegmentation_ = 0;
+	double slmPupilRadius_ = 0;
+	std::string slmIndexMapFile_ = "";
+	// Genes of the GAs as coefficients of a BasisType value (0 for a gene per bin), the number of modes and the phase of a mode at full coefficient in waves
+	// (only set through "optimizationBasis", "basisModes" and "basisAmplitude" of a settings file)
+	int optimizationBasis_ = 0;
+	int basisModes_ = 15;
+	double basisAmplitude_ = 1;
+	// Software phase stage of the scaled SLM images: a LUT file ("level value" lines as the Blink .LUT files, the board should then have a linear LUT)
+	// and an 8 bit image of phase levels added under the genome, such as the SLM image of an earlier run without a software LUT ("" for none)
+	// (only set through "softwareLUTFile" and "basePhaseFile" of a settings file)
+	std::string softwareLUTFile_ = "";
+	std::string basePhaseFile_ = "";
 
 	// Display About Window as popup from button press
 	afx_msg void OnBnClickedAboutButton();
@@ -0,0 +1,212 @@
+////////////////////
+// ModalBasis.cpp - implementation of ModalBasis class
+////////////////////
+
+#include "stdafx.h"
+#include "ModalBasis.h"
+#include "GenomeTraits.h"	// levels and depth1_shift of the gene types
+
+#include <algorithm> // std::min, std::max & std::sort
+#include <cmath>	 // std::cos, std::sin, std::atan2...
+#include <utility>	 // std::pair
+
+// Instruction set is chosen at compile time, AVX2 when building with /arch:AVX2 otherwise SSE2 (always present on x64)
+// Define MODAL_BASIS_FORCE_SCALAR to use the plain C++ path
+#if !defined(MODAL_BASIS_FORCE_SCALAR) && defined(__AVX2__)
+#define MODAL_BASIS_AVX2
+#include <immintrin.h>
+#elif !defined(MODAL_BASIS_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define MODAL_BASIS_SSE2
+#include <emmintrin.h>
+#endif
+
+static const double pi = 3.14159265358979323846;
+static const int cellsPerVector = 8;	// Cells are padded to a multiple of this (one AVX2 vector of 32 bit sums)
+static const int hadamardBits = 6;		// Walsh patterns are over a 64 x 64 grid
+
+// Zernike (n, m) of Noll index j (1 is piston)
+static void nollToZernike(int j, int & n, int & m) {
+	n = 0;
+	int j1 = j - 1;
+	while (j1 > n) {
+		n++;
+		j1 -= n;
+	}
+	m = ((j % 2 == 0) ? 1 : -1) * ((n % 2) + 2 * ((j1 + ((n + 1) % 2)) / 2));
+}
+
+// Zernike polynomial of Noll index j at polar coordinates (rho, theta), peak value 1 over the unit disc
+static double zernike(int j, double rho, double theta) {
+	int n, m;
+	nollToZernike(j, n, m);
+	const int am = (m < 0) ? -m : m;
+	double radial = 0;
+	for (int k = 0; k <= (n - am) / 2; k++) {
+		double c = ((k % 2) ? -1.0 : 1.0);
+		for (int f = 2; f <= n - k; f++) c *= f;
+		for (int f = 2; f <= k; f++) c /= f;
+		for (int f = 2; f <= (n + am) / 2 - k; f++) c /= f;
+		for (int f = 2; f <= (n - am) / 2 - k; f++) c /= f;
+		radial += c * std::pow(rho, n - 2 * k);
+	}
+	if (m == 0) {
+		return radial;
+	}
+	return radial * ((m > 0) ? std::cos(am * theta) : std::sin(am * theta));
+}
+
+// Hadamard row of the Walsh function with sequency s (number of sign changes) over 2^hadamardBits points
+static int walshRow(int s) {
+	const int gray = s ^ (s >> 1);
+	int row = 0;
+	for (int b = 0; b < hadamardBits; b++) {
+		if (gray & (1 << b)) {
+			row |= 1 << (hadamardBits - 1 - b);
+		}
+	}
+	return row;
+}
+
+// +1 or -1, Walsh function of sequency s at grid point g
+static double walsh(int s, int g) {
+	int bits = walshRow(s) & g, parity = 0;
+	for (; bits != 0; bits &= bits - 1) {
+		parity ^= 1;
+	}
+	return parity ? -1.0 : 1.0;
+}
+
+std::shared_ptr<ModalBasis> ModalBasis::create(BasisType type, int modeCount, const std::vector<double> & cellX, const std::vector<double> & cellY,
+	double centerX, double centerY, double radius, double amplitude) {
+	const int grid = 1 << hadamardBits;
+	if (type == BasisType::Bins || modeCount <= 0 || cellX.empty() || cellX.size() != cellY.size() || radius <= 0 || amplitude <= 0
+		|| (type == BasisType::Hadamard && modeCount > grid * grid - 1)) {
+		return NULL;
+	}
+	std::shared_ptr<ModalBasis> basis(new ModalBasis());
+	basis->type_ = type;
+	basis->mode_count_ = modeCount;
+	basis->cell_count_ = int(cellX.size());
+	basis->padded_cells_ = (basis->cell_count_ + cellsPerVector - 1) / cellsPerVector * cellsPerVector;
+	basis->amplitude_ = (std::min)(amplitude, 63.0);
+	basis->pairs_.assign(size_t(modeCount + 1) / 2 * basis->padded_cells_ * 2, 0);
+
+	// Mode orders, (x, y) sequency for Hadamard and (x, y) frequency for Fourier (each frequency gives a cos then a sin mode)
+	std::vector<std::pair<int, int>> orders;
+	if (type == BasisType::Hadamard) {
+		for (int sum = 1; int(orders.size()) < modeCount; sum++) {
+			for (int sy = (std::max)(0, sum - grid + 1); sy <= (std::min)(sum, grid - 1); sy++) {
+				orders.push_back(std::make_pair(sum - sy, sy));
+			}
+		}
+	}
+	else if (type == BasisType::Fourier) {
+		const int limit = int(std::sqrt(double(modeCount))) + 2;
+		for (int ky = 0; ky <= limit; ky++) {
+			for (int kx = -limit; kx <= limit; kx++) {
+				if (ky > 0 || kx > 0) {
+					orders.push_back(std::make_pair(kx, ky));
+				}
+			}
+		}
+		std::stable_sort(orders.begin(), orders.end(), [](const std::pair<int, int> & a, const std::pair<int, int> & b) {
+			return a.first * a.first + a.second * a.second < b.first * b.first + b.second * b.second;
+		});
+	}
+
+	const double scale = basis->amplitude_ * 65536 / 128; // Mode value to 16 bit phase per unit of coefficient
+	for (int mode = 0; mode < modeCount; mode++) {
+		int16_t * values = basis->pairs_.data() + size_t(mode / 2) * basis->padded_cells_ * 2 + (mode % 2);
+		for (int cell = 0; cell < basis->cell_count_; cell++) {
+			const double u = (cellX[cell] - centerX) / radius, v = (cellY[cell] - centerY) / radius;
+			double value = 0;
+			switch (type) {
+			case BasisType::Zernike: {
+				const double rho = std::sqrt(u * u + v * v);
+				value = (rho <= 1) ? zernike(mode + 2, rho, std::atan2(v, u)) : 0;
+				break;
+			}
+			case BasisType::Hadamard: {
+				const int gx = (std::max)(0, (std::min)(grid - 1, int(std::floor((u + 1) / 2 * grid))));
+				const int gy = (std::max)(0, (std::min)(grid - 1, int(std::floor((v + 1) / 2 * grid))));
+				value = walsh(orders[mode].first, gx) * walsh(orders[mode].second, gy);
+				break;
+			}
+			default: {
+				const double phase = pi * (orders[mode / 2].first * u + orders[mode / 2].second * v);
+				value = (mode % 2) ? std::sin(phase) : std::cos(phase);
+				break;
+			}
+			}
+			values[size_t(cell) * 2] = int16_t((std::max)(-32767.0, (std::min)(32767.0, std::floor(value * scale + 0.5))));
+		}
+	}
+	return basis;
+}
+
+// Sum of coefficient * mode for each cell in 1/65536 of a wave, two modes per multiply-add, then wrapped to the gene levels
+template <class T>
+void ModalBasis::render(const T * coefficients, T * cells) const {
+	const int pairCount = (this->mode_count_ + 1) / 2;
+	// Coefficients as 16 bit pairs, (low mode, high mode) packed in one 32 bit value
+	std::vector<int32_t> packed(pairCount, 0);
+	for (int mode = 0; mode < this->mode_count_; mode++) {
+		const int c = (int(coefficients[mode]) >> GenomeTraits<T>::depth1_shift) - 128;
+		packed[mode / 2] |= int32_t(uint16_t(int16_t(c))) << (16 * (mode % 2));
+	}
+	// 16 bit phase to the gene levels, rounding to nearest
+	const int shift = 8 - GenomeTraits<T>::depth1_shift;
+	const int32_t round = (shift > 0) ? (1 << (shift - 1)) : 0;
+	const int32_t mask = GenomeTraits<T>::levels - 1;
+
+	int32_t sums[cellsPerVector];
+	for (int first = 0; first < this->cell_count_; first += cellsPerVector) {
+		const int16_t * values = this->pairs_.data() + size_t(first) * 2;
+#if defined(MODAL_BASIS_AVX2)
+		__m256i sum = _mm256_setzero_si256();
+		for (int p = 0; p < pairCount; p++, values += size_t(this->padded_cells_) * 2) {
+			sum = _mm256_add_epi32(sum, _mm256_madd_epi16(_mm256_loadu_si256((const __m256i*)values), _mm256_set1_epi32(packed[p])));
+		}
+		_mm256_storeu_si256((__m256i*)sums, sum);
+#elif defined(MODAL_BASIS_SSE2)
+		__m128i low = _mm_setzero_si128(), high = _mm_setzero_si128();
+		for (int p = 0; p < pairCount; p++, values += size_t(this->padded_cells_) * 2) {
+			const __m128i c = _mm_set1_epi32(packed[p]);
+			low = _mm_add_epi32(low, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)values), c));
+			high = _mm_add_epi32(high, _mm_madd_epi16(_mm_loadu_si128((const __m128i*)(values + 8)), c));
+		}
+		_mm_storeu_si128((__m128i*)sums, low);
+		_mm_storeu_si128((__m128i*)(sums + 4), high);
+#else
+		std::fill(sums, sums + cellsPerVector, 0);
+		for (int p = 0; p < pairCount; p++, values += size_t(this->padded_cells_) * 2) {
+			const int c0 = int16_t(packed[p] & 0xFFFF), c1 = int16_t(packed[p] >> 16);
+			for (int k = 0; k < cellsPerVector; k++) {
+				sums[k] += c0 * values[k * 2] + c1 * values[k * 2 + 1];
+			}
+		}
+#endif
+		const int count = (std::min)(cellsPerVector, this->cell_count_ - first);
+		for (int k = 0; k < count; k++) {
+			cells[first + k] = T(((sums[k] + round) >> shift) & mask);
+		}
+	}
+}
+
+std::string ModalBasis::typeName(BasisType type) {
+	switch (type) {
+	case BasisType::Zernike:
+		return "Zernike";
+	case BasisType::Hadamard:
+		return "Hadamard";
+	case BasisType::Fourier:
+		return "Fourier";
+	default:
+		return "Bins";
+	}
+}
+
+// Gene types the basis is rendered for (as with ImageScaler)
+template void ModalBasis::render<int>(const int * coefficients, int * cells) const;
+template void ModalBasis::render<unsigned char>(const unsigned char * coefficients, unsigned char * cells) const;
+template void ModalBasis::render<unsigned short>(const unsigned short * coefficients, unsigned short * cells) const;
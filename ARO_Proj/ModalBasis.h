@@ -0,0 +1,77 @@
+////////////////////
+// ModalBasis.h - genomes as coefficients of a few phase modes (Zernike, Hadamard or Fourier) instead of one phase value per bin
+////////////////////
+
+#ifndef MODAL_BASIS_H_
+#define MODAL_BASIS_H_
+
+#include <cstdint>
+#include <memory>	// std::shared_ptr
+#include <string>
+#include <vector>
+
+// Basis the genes of an optimization are coefficients of, Bins is the usual one gene per bin (no basis)
+enum class BasisType {
+	Bins = 0,
+	Zernike = 1,	// Zernike polynomials in Noll order from tip/tilt (piston is left out), over the unit disc
+	Hadamard = 2,	// 2D Walsh patterns in increasing sequency (constant pattern left out), over the square around the unit disc
+	Fourier = 3		// cos and sin plane waves in increasing spatial frequency, half a period across the unit radius for the lowest
+};
+
+// Mode values sampled at each cell (bin or index map gene) of an ImageScaler, turning a genome of coefficients into cell phases.
+// A coefficient gene maps to [-1, 1) (8 bit resolution, the high byte of 16 bit genes) and scales its mode to that many times the amplitude,
+// the phases of all modes are summed and wrapped to the phase levels of the gene type.
+// The modes are stored as 16 bit fixed point values in pairs interleaved per cell so a multiply-add does two modes at once.
+class ModalBasis {
+private:
+	BasisType type_;
+	int mode_count_;
+	int cell_count_;
+	int padded_cells_;	// cell_count_ rounded up to a whole vector of cells
+	double amplitude_;
+	// Mode value * amplitude in 1/65536 of a wave / 128, mode pair p at [(p * padded_cells_ + cell) * 2], its second mode right after
+	std::vector<int16_t> pairs_;
+
+	ModalBasis() {
+	}
+
+public:
+	// Sample a basis at cell positions
+	// Input:
+	//	type - basis (not Bins)
+	//	modeCount - number of modes (genome length)
+	//	cellX, cellY - position of each cell in pixels
+	//	centerX, centerY, radius - the unit disc in pixels (the pupil the modes are defined over)
+	//	amplitude - phase of a mode at its peak for the largest coefficient, in waves (at most 63)
+	// Output: the basis, NULL if the arguments are invalid
+	static std::shared_ptr<ModalBasis> create(BasisType type, int modeCount, const std::vector<double> & cellX, const std::vector<double> & cellY,
+		double centerX, double centerY, double radius, double amplitude);
+
+	// Phase of each cell for a genome of coefficients, wrapped to the levels of T (see GenomeTraits.h)
+	// Defined in ModalBasis.cpp for int, unsigned char and unsigned short
+	// Input: coefficients - getModeCount() genes
+	//		  cells - set to getCellCount() phases
+	template <class T>
+	void render(const T * coefficients, T * cells) const;
+
+	const BasisType getType() const {
+		return this->type_;
+	}
+
+	const int getModeCount() const {
+		return this->mode_count_;
+	}
+
+	const int getCellCount() const {
+		return this->cell_count_;
+	}
+
+	const double getAmplitude() const {
+		return this->amplitude_;
+	}
+
+	// Name of a basis for logs ("Zernike" for example)
+	static std::string typeName(BasisType type);
+};
+
+#endif
@@ -6,6 +6,10 @@
 #include "stdafx.h"				// Required in source
 #include "Optimization.h"		// Header file
 #include "Utility.h"			// use printLine()
+#include "FastRandom.h"			// randomSeed() when no seed is given
+
+#include <algorithm>	// std::min & std::max
+#include <cmath>		// std::abs
 
 Optimization::Optimization(MainDialog* dlg, CameraController* cc, SLMController* sc) {
 	if (cc == nullptr) {
@@ -187,6 +191,117 @@ bool Optimization::prepareOutputSettings() {
 	return true;
 }
 
+// Read the multiple target spots ("x,y,r,w" separated by ';', the weight may be left out)
+bool Optimization::prepareTargetSpots(FitnessTargets & targets) {
+	targets.aggregator = TargetAggregator(this->dlg->targetAggregator_);
+	std::vector<std::string> spots = Utility::seperateByDelim(this->dlg->targetSpots_, ';');
+	for (int i = 0; i < spots.size(); i++) {
+		std::vector<std::string> values = Utility::seperateByDelim(spots[i], ',');
+		try {
+			if (values.size() < 3 || values.size() > 4) {
+				throw std::invalid_argument(spots[i]);
+			}
+			const double weight = (values.size() == 4) ? std::stod(values[3]) : 1;
+			if (weight < 0) {
+				throw std::invalid_argument(spots[i]);
+			}
+			targets.spots.push_back(TargetSpot(TargetShape(std::stoi(values[2]), std::stod(values[0]), std::stod(values[1])), weight));
+		}
+		catch (std::exception&) {
+			return false;
+		}
+	}
+	return true;
+}
+
+// Index maps are built once per run, a map file is only opened once and shared by boards of its size
+bool Optimization::prepareIndexMaps() {
+	this->indexMaps.clear();
+	const bool fromFile = !this->dlg->slmIndexMapFile_.empty();
+	if (!fromFile && this->dlg->slmSegmentation_ == 0 && this->dlg->slmPupilRadius_ <= 0) {
+		return true; // Rectangular bins over the whole SLM, the scalers need no map
+	}
+	std::shared_ptr<IndexMap> loaded = fromFile ? IndexMap::load(this->dlg->slmIndexMapFile_) : NULL;
+	if (fromFile && loaded == NULL) {
+		return false;
+	}
+	for (int i = 0; i < this->optBoards.size(); i++) {
+		const int width = int(this->sc->getBoardWidth(i));
+		const int height = int(this->sc->getBoardHeight(i));
+		std::shared_ptr<IndexMap> map;
+		if (fromFile) {
+			if (loaded->getWidth() != width || loaded->getHeight() != height) {
+				Utility::printLine("ERROR: index map " + this->dlg->slmIndexMapFile_ + " does not match the size of board #" + std::to_string(this->optBoards[i]->board_id) + "!");
+				this->indexMaps.clear();
+				return false;
+			}
+			map = loaded;
+		}
+		else if (this->dlg->slmSegmentation_ == 1) {
+			map = IndexMap::hexagonal(width, height, this->cc->binSizeX, this->dlg->slmPupilRadius_);
+		}
+		else {
+			map = IndexMap::rectangular(width, height, this->cc->binSizeX, this->cc->binSizeY, this->cc->numberOfBinsX, this->cc->numberOfBinsY, this->dlg->slmPupilRadius_);
+		}
+		if (map == NULL) {
+			Utility::printLine("ERROR: SLM segmentation of board #" + std::to_string(this->optBoards[i]->board_id) + " has no genes!");
+			this->indexMaps.clear();
+			return false;
+		}
+		Utility::printLine("INFO: Board #" + std::to_string(this->optBoards[i]->board_id) + " has " + std::to_string(map->getGeneCount()) + " genes");
+		this->indexMaps.push_back(map);
+	}
+	return true;
+}
+
+// Modes of the basis, genes of the board's index map, or one per rectangular bin
+int Optimization::genomeLength(int popID) const {
+	if (this->basisType != BasisType::Bins) {
+		return this->basisModes;
+	}
+	if (popID < this->indexMaps.size()) {
+		return this->indexMaps[popID]->getGeneCount() * this->cc->populationDensity;
+	}
+	return this->cc->numberOfBinsY * this->cc->numberOfBinsX * this->cc->populationDensity;
+}
+
+// Ask for a shorter exposure when the frames are about to saturate
+void Optimization::controlExposure(ImageController * image, double targetMean) {
+	FrameHistogram histogram;
+	histogram.build(image->getPixelData(), image->getPixelEncoding(), image->getWidth(), image->getHeight());
+
+	std::unique_lock<std::mutex> exposureLock(this->exposureMutex);
+	const double exposure = this->exposureControl.observe(image->getExposureTime(), targetMean, histogram);
+	if (exposure < this->requestedExposure) {
+		this->requestedExposure = exposure;
+		this->pendingExposure = exposure;
+	}
+}
+
+// Shorten the exposure between acquisitions (the camera is not changed while a frame is being acquired)
+void Optimization::applyPendingExposure() {
+	std::unique_lock<std::mutex> exposureLock(this->exposureMutex);
+	const double exposure = this->pendingExposure;
+	this->pendingExposure = 0;
+	exposureLock.unlock();
+	if (exposure > 0 && this->cc->ChangeExposure(exposure)) {
+		if (this->saveExposureShorten || this->logAllFiles) {
+			this->efile << "Exposure shortened at " << this->timestamp->MS_SinceStart() << " ms to " << this->cc->finalExposureTime << " us with new ratio " << this->cc->GetExposureRatio() << std::endl;
+		}
+	}
+}
+
+// Spot values scaled as the fitness, empty for a single target
+std::string Optimization::spotColumns(const std::vector<double> & spotMeans, double scale, char delim) const {
+	std::string columns = "";
+	if (spotMeans.size() > 1) {
+		for (int i = 0; i < spotMeans.size(); i++) {
+			columns += delim + std::to_string(spotMeans[i] * scale);
+		}
+	}
+	return columns;
+}
+
 // Setup camera, verify SLM is ready (setting up the board vector) and prepare stop conditions
 bool Optimization::prepareSoftwareHardware() {
 	Utility::printLine("INFO: Preparing equipment and software for optimization!");
@@ -204,6 +319,22 @@ bool Optimization::prepareSoftwareHardware() {
 		return false;
 	}
 	Utility::printLine("INFO: Camera setup complete!");
+	FitnessTargets targets(TargetShape(this->cc->targetRadius, this->dlg->targetOffsetX_, this->dlg->targetOffsetY_, this->dlg->targetAspect_));
+	FitnessType fitnessType = FitnessType(this->dlg->fitnessFunction_);
+	if (fitnessType == FitnessType::MultiTarget) {
+		if (!prepareTargetSpots(targets)) {
+			Utility::printLine("WARNING: could not read all the target spots \"" + this->dlg->targetSpots_ + "\"!");
+		}
+		if (targets.spots.empty()) {
+			Utility::printLine("WARNING: no target spots given, using the single target!");
+			fitnessType = FitnessType::MeanIntensity;
+		}
+	}
+	this->fitnessFunction.reset(fitnessType, this->cc->cameraImageWidth, this->cc->cameraImageHeight, targets);
+	Utility::printLine("INFO: Fitness function is " + this->fitnessFunction.getName());
+	this->exposureControl.reset(this->cc->finalExposureTime, this->maxFitnessValue);
+	this->requestedExposure = this->cc->finalExposureTime;
+	this->pendingExposure = 0;
 
 	if (!this->sc->updateFromGUI()) {
 		Utility::printLine("ERROR: SLM setup has failed!");
@@ -224,12 +355,35 @@ bool Optimization::prepareSoftwareHardware() {
 	for (int i = 0; i < this->optBoards.size(); i++) {
 		Utility::printLine("INFO:   #" + std::to_string(this->optBoards[i]->board_id));
 	}
+	if (!prepareIndexMaps()) {
+		Utility::printLine("ERROR: Preparing the SLM segmentation has failed!");
+		return false;
+	}
 
 	// - configure algorithm parameters
 	if (!prepareStopConditions()) {
 		Utility::printLine("ERROR: Preparing stop conditions has failed!");
 		return false;
 	}
+	// Seed is recorded in the parameters file so any run can be repeated by setting rngSeed in a settings file
+	this->rngSeed = (this->dlg->rngSeed_ == 0) ? FastRandom::randomSeed() : this->dlg->rngSeed_;
+	Utility::printLine("INFO: Random number generators seeded with " + std::to_string(this->rngSeed));
+	this->mutationRate = this->dlg->mutationRate_;
+	this->useSLMFrameBank = this->dlg->slmFrameBank_;
+	this->useFrameMatching = this->dlg->syncAcquisition_;
+	this->slmSettleTime = this->dlg->slmSettleTime_;
+	this->useFitnessCache = this->dlg->useFitnessCache_;
+	this->fitnessCacheTTL = this->dlg->fitnessCacheTTL_;
+	this->basisType = BasisType(this->dlg->optimizationBasis_);
+	if (this->basisType != BasisType::Bins) {
+		if (this->basisType != BasisType::Zernike && this->basisType != BasisType::Hadamard && this->basisType != BasisType::Fourier) {
+			Utility::printLine("WARNING: unknown optimization basis " + std::to_string(this->dlg->optimizationBasis_) + ", using a gene per bin!");
+			this->basisType = BasisType::Bins;
+		}
+		this->basisModes = (std::max)(1, (std::min)(this->dlg->basisModes_, 4095)); // Hadamard has 64 x 64 - 1 patterns
+		this->basisAmplitude = (this->dlg->basisAmplitude_ > 0) ? this->dlg->basisAmplitude_ : 1;
+		Utility::printLine("INFO: Genes are coefficients of " + std::to_string(this->basisModes) + " " + ModalBasis::typeName(this->basisType) + " modes");
+	}
 	Utility::printLine("INFO: Hardware ready!");
 
 	// - configure proper UI states
@@ -239,6 +393,32 @@ bool Optimization::prepareSoftwareHardware() {
 	return true;
 }
 
+// Read the software LUT and the base phase image (8 bit grayscale, of the board size)
+std::shared_ptr<PhaseCorrection> Optimization::preparePhaseCorrection(int width, int height) {
+	if (this->dlg->softwareLUTFile_.empty() && this->dlg->basePhaseFile_.empty()) {
+		return NULL;
+	}
+	std::shared_ptr<PhaseCorrection> correction(new PhaseCorrection(width, height));
+	if (!this->dlg->softwareLUTFile_.empty()) {
+		if (correction->loadLUT(this->dlg->softwareLUTFile_)) {
+			Utility::printLine("INFO: Software LUT " + this->dlg->softwareLUTFile_ + " loaded, the board should have a linear LUT so it is not applied twice");
+		}
+		else {
+			Utility::printLine("WARNING: software LUT not used!");
+		}
+	}
+	if (!this->dlg->basePhaseFile_.empty()) {
+		cv::Mat base = cv::imread(this->dlg->basePhaseFile_, cv::IMREAD_GRAYSCALE);
+		if (base.empty() || base.cols != width || base.rows != height) {
+			Utility::printLine("WARNING: base phase " + this->dlg->basePhaseFile_ + " could not be read or is not " + std::to_string(width) + "x" + std::to_string(height) + ", not used!");
+		}
+		else {
+			correction->setBasePhase(base.data); // imread gives a continuous image
+		}
+	}
+	return correction;
+}
+
 // For a given board setup and return a scaler
 // Input: slmNum (default 0 and 0 based) - index of board to set scaler with
 //        slmImg - char pointer to array with size equal to total area of board
@@ -251,6 +431,28 @@ ImageScaler* Optimization::setupScaler(unsigned char *slmImg, int slmNum = 0) {
 	ImageScaler* scaler = new ImageScaler(width, height, 1);
 	scaler->SetBinSize(cc->binSizeX, cc->binSizeY);
 	scaler->SetUsedBins(cc->numberOfBinsX, cc->numberOfBinsY);
+	if (slmNum < this->indexMaps.size() && !scaler->SetIndexMap(this->indexMaps[slmNum])) {
+		Utility::printLine("WARNING: index map does not fit board " + std::to_string(slmNum) + ", using rectangular bins!");
+	}
+	if (this->basisType != BasisType::Bins) {
+		// Modes over the pupil, or the largest disc around the SLM center the cells reach in both directions
+		std::vector<double> cellX, cellY;
+		scaler->GetCellCenters(cellX, cellY);
+		double reachX = 0, reachY = 0;
+		for (int i = 0; i < cellX.size(); i++) {
+			reachX = (std::max)(reachX, std::abs(cellX[i] - width / 2.0));
+			reachY = (std::max)(reachY, std::abs(cellY[i] - height / 2.0));
+		}
+		const double radius = (this->dlg->slmPupilRadius_ > 0) ? this->dlg->slmPupilRadius_ : (std::min)(reachX, reachY);
+		std::shared_ptr<ModalBasis> basis = ModalBasis::create(this->basisType, this->basisModes, cellX, cellY, width / 2.0, height / 2.0, radius, this->basisAmplitude);
+		if (basis == NULL || !scaler->SetModalBasis(basis)) {
+			Utility::printLine("ERROR: could not sample the " + ModalBasis::typeName(this->basisType) + " modes on board " + std::to_string(slmNum) + "!");
+		}
+	}
+	std::shared_ptr<PhaseCorrection> correction = preparePhaseCorrection(width, height);
+	if (correction != NULL && !scaler->SetPhaseCorrection(correction)) {
+		Utility::printLine("WARNING: phase correction does not fit board " + std::to_string(slmNum) + ", not used!");
+	}
 	scaler->ZeroOutputImage(slmImg); // Initialize the slm image array to be all zeros
 
 	return scaler;
@@ -269,6 +471,27 @@ void Optimization::saveParameters(std::string time) {
 		paramFile << "Max Stop Time - " << std::to_string(this->maxSecondsToStop) << std::endl;
 		paramFile << "Min Generation - " << std::to_string(this->genEvalToStop) << std::endl;
 		paramFile << "Max Generation - " << std::to_string(this->maxGenenerations) << std::endl;;
+		paramFile << "Mutation Rate - " << std::to_string(this->mutationRate) << std::endl;
+		paramFile << "RNG Seed - " << std::to_string(this->rngSeed) << std::endl;
+		paramFile << "SLM Frame Bank - " << std::to_string(this->useSLMFrameBank) << std::endl;
+		if (this->useSLMFrameBank) {
+			paramFile << "SLM Frame Bank Resident Generations - " << std::to_string(this->residentFrameGenerations) << std::endl;
+		}
+		paramFile << "Synchronized Acquisition - " << std::to_string(this->useFrameMatching) << std::endl;
+		paramFile << "SLM Settle Time (us) - " << std::to_string(this->slmSettleTime) << std::endl;
+		paramFile << "Fitness Cache - " << std::to_string(this->useFitnessCache) << std::endl;
+		paramFile << "Fitness Cache TTL (generations) - " << std::to_string(this->fitnessCacheTTL) << std::endl;
+		paramFile << "Fitness Function - " << this->fitnessFunction.getName() << std::endl;
+		paramFile << "Target Offset X - " << std::to_string(this->fitnessFunction.getTargets().shape.offsetX) << std::endl;
+		paramFile << "Target Offset Y - " << std::to_string(this->fitnessFunction.getTargets().shape.offsetY) << std::endl;
+		paramFile << "Target Aspect - " << std::to_string(this->fitnessFunction.getTargets().shape.aspect) << std::endl;
+		if (this->fitnessFunction.getType() == FitnessType::MultiTarget) {
+			const std::vector<TargetSpot> & spots = this->fitnessFunction.getTargets().spots;
+			for (int i = 0; i < spots.size(); i++) {
+				paramFile << "Target Spot " << std::to_string(i + 1) << " (x,y,radius,weight) - " << std::to_string(spots[i].shape.offsetX) << "," << std::to_string(spots[i].shape.offsetY) << ","
+					<< std::to_string(spots[i].shape.radius) << "," << std::to_string(spots[i].weight) << std::endl;
+			}
+		}
 	}
 	paramFile << "----------------------------------------------------------------" << std::endl;
 	paramFile << "CAMERA SETTINGS:" << std::endl;
@@ -284,6 +507,19 @@ void Optimization::saveParameters(std::string time) {
 	paramFile << "Bins Size X - " << std::to_string(this->cc->numberOfBinsX) << std::endl;
 	paramFile << "Bins Size Y - " << std::to_string(this->cc->numberOfBinsY) << std::endl;
 	paramFile << "Target Radius - " << std::to_string(this->cc->targetRadius) << std::endl;
+	paramFile << "SLM Segmentation - " << ((this->dlg->slmSegmentation_ == 1) ? "Hexagonal" : "Rectangular") << std::endl;
+	paramFile << "SLM Pupil Radius - " << std::to_string(this->dlg->slmPupilRadius_) << std::endl;
+	paramFile << "SLM Index Map File - " << this->dlg->slmIndexMapFile_ << std::endl;
+	for (int i = 0; i < this->indexMaps.size(); i++) {
+		paramFile << "Board #" << this->optBoards[i]->board_id << " Genes - " << std::to_string(this->indexMaps[i]->getGeneCount()) << std::endl;
+	}
+	paramFile << "Software LUT File - " << this->dlg->softwareLUTFile_ << std::endl;
+	paramFile << "Base Phase File - " << this->dlg->basePhaseFile_ << std::endl;
+	paramFile << "Optimization Basis - " << ModalBasis::typeName(this->basisType) << std::endl;
+	if (this->basisType != BasisType::Bins) {
+		paramFile << "Basis Modes - " << std::to_string(this->basisModes) << std::endl;
+		paramFile << "Basis Amplitude (waves) - " << std::to_string(this->basisAmplitude) << std::endl;
+	}
 	paramFile << "----------------------------------------------------------------" << std::endl;
 	paramFile << "SLM SETTINGS:" << std::endl;
 	paramFile << "Board Amount - " << std::to_string(this->sc->numBoards) << std::endl;
@@ -18,6 +18,11 @@
 #include "Timing.h"				// contains time keeping functions
 #include "ImageScaler.h"		// changes size of image to fit slm
 #include "CameraDisplay.h"		// display Camera & SLM images to the user in distinct windows
+#include "FitnessPolicies.h"	// fitness of a camera image
+#include "ExposureController.h"	// shortening the exposure before the camera saturates
+#include "IndexMap.h"			// genes of SLM segmentations other than rectangular bins
+#include "ModalBasis.h"			// genes as coefficients of phase modes
+#include "PhaseCorrection.h"		// software LUT and base phase of the SLM images
 
 class Optimization {
 protected:
@@ -29,8 +34,19 @@ protected:
 
 	//Base algorithm parameters
 	double acceptedSimilarity = .97;  // images considered the same when reach this threshold (has to be less than 1)
-	double maxFitnessValue = 200;  // max allowed fitness value - when reached exposure is halved (TODO: check this feature)
+	double mutationRate = 1.0 / 200;  // chance for each gene of a new individual to mutate (SGA and steady state), set from MainDialog in prepareSoftwareHardware()
+	unsigned long long rngSeed = 0;   // seed for the random number generators, set from MainDialog (drawn randomly if 0) in prepareSoftwareHardware()
+	double maxFitnessValue = 200;  // max allowed target intensity - exposure is shortened before it is reached (exposureControl)
 	double maxGenenerations = 3000; // max number of generations to perform
+	bool useSLMFrameBank = false;	// TRUE -> GAs upload a generation of frames to SLM RAM and select them per individual, set from MainDialog in prepareSoftwareHardware()
+	int residentFrameGenerations = 0;	// Number of generations of the run whose frames were selected from SLM RAM (when useSLMFrameBank), for the parameters file
+	bool useFrameMatching = false;	// TRUE -> GAs only use camera frames exposed after the written pattern settled (FrameMatcher), set from MainDialog in prepareSoftwareHardware()
+	double slmSettleTime = 10000;	// time for a written pattern to settle on the SLM in microseconds (when useFrameMatching)
+	bool useFitnessCache = true;	// TRUE -> GAs reuse the fitness of genomes measured recently (see FitnessCache.h), set from MainDialog in prepareSoftwareHardware()
+	int fitnessCacheTTL = 10;		// Number of generations a measured fitness is reused for (when useFitnessCache)
+	BasisType basisType = BasisType::Bins;	// Genes are coefficients of these modes instead of bin values (see ModalBasis.h), set from MainDialog in prepareSoftwareHardware()
+	int basisModes = 15;			// Number of modes (genome length) when basisType is not Bins
+	double basisAmplitude = 1;		// Phase of a mode at full coefficient in waves
 
 	//Base algorithm stop conditions
 	double fitnessToStop = 0;
@@ -55,16 +71,21 @@ protected:
 	// Values assigned within setupInstanceVariables(), then if needed cleared in shutdownOptimizationInstance()
 	bool isWorking = false;		// true if currently actively running the optimization algorithm
 	bool usingHardware = false; // debug flag of using hardware currently in a run of an individual (to know if accidentally having two threads use hardware at once!)
-	bool shortenExposureFlag;   // Set to true by individual if fitness is too high
 	bool stopConditionsMetFlag; // Set to true if a stop condition was reached by one of the individuals
 	CameraDisplay * camDisplay; // Display for camera
 	std::vector<CameraDisplay *> slmDisplayVector; // Display for SLM (currently [June 24th 2021] only board at index 0)
 	TimeStampGenerator * timestamp; // Timer to track and store elapsed time as the algorithm executes
 
 	ImageController * bestImage; // Current camera image found to have best resulting fitness from elite individuals
+	FitnessFunction fitnessFunction; // Fitness of a camera image, reset to the selected function, camera image size and target in prepareSoftwareHardware()
+	ExposureController exposureControl; // Decides when to shorten the exposure from the measured frames, reset in prepareSoftwareHardware()
+	double requestedExposure = 0;		// Shortest exposure exposureControl asked for so far (microseconds)
+	double pendingExposure = 0;			// Exposure asked for but not yet set on the camera, 0 for none (see applyPendingExposure())
+	std::mutex exposureMutex;			// Serializes exposureControl, requestedExposure and pendingExposure
 	std::vector<ImageScaler*> scalers; // Image scalers for each SLM (each SLM may have different dimensions so can't have just one)
 	std::vector<unsigned char*> slmScaledImages; // To easily store the scaled images from individual to what will be written
 	std::vector<SLM_Board*> optBoards; // Vector to hold pointers of boards taken from SLMController that are to be optimized (do not delete the boards here!)
+	std::vector<std::shared_ptr<IndexMap>> indexMaps; // Gene of each pixel for every board in optBoards, empty when the SLM is split into the rectangular bins (prepareIndexMaps())
 
 	// Logging file streams
 	std::ofstream tfile;				// Record elite individual progress over generations
@@ -79,8 +100,43 @@ protected:
 	bool prepareSoftwareHardware();
 	// Pull GUI settings for output settings such as save images
 	bool prepareOutputSettings();
+	// Parse the spots of the multiple target fitness from MainDialog::targetSpots_ ("x,y,r,w;x,y,r,w;...")
+	// Input: targets - spots appended to, aggregator set from MainDialog::targetAggregator_
+	// Output: returns false if a spot could not be read (spots read before it are kept)
+	bool prepareTargetSpots(FitnessTargets & targets);
+	// Build the index map of each board in optBoards from the MainDialog segmentation settings (pupil, hexagonal cells or a map file)
+	// Output: indexMaps set, left empty for the plain rectangular bins, returns false if a map could not be made
+	bool prepareIndexMaps();
+	// Number of genes of an individual of a population (modes of the basis, or cells of the board)
+	// Input: popID - index of the board in optBoards the population is for
+	int genomeLength(int popID) const;
+
+	// Feed a measured frame to exposureControl, queueing a shorter camera exposure if it asks for it
+	// Called from the threads processing frames, the camera is only changed by applyPendingExposure()
+	// Input:
+	//	image - the frame (its pixels and the exposure it was taken with)
+	//	targetMean - mean of the target given by fitnessFunction.evaluate()
+	// Output: pendingExposure set if needed
+	void controlExposure(ImageController * image, double targetMean);
+
+	// Set the exposure queued by controlExposure() on the camera, called by the thread using the hardware between acquisitions
+	// Output: camera exposure changed and recorded in efile if one was queued
+	void applyPendingExposure();
 
-	// Creates a scaler with given SLMController
+	// Per target columns of a timeVsFitnessFile line (nothing unless the fitness has several targets)
+	// Input:
+	//	spotMeans - mean intensity of each target given by fitnessFunction.evaluate()
+	//	scale - factor applied to the fitness (fitnessScale()), applied to the spot values too
+	//	delim - column separator of the file
+	// Output: the columns, each preceded by delim
+	std::string spotColumns(const std::vector<double> & spotMeans, double scale, char delim) const;
+
+	// Phase correction stage of a board from the software LUT and base phase files of MainDialog
+	// Input: width, height - size of the board's images
+	// Output: the stage, NULL if neither file is set (problems reading them are printed and that part left out)
+	std::shared_ptr<PhaseCorrection> preparePhaseCorrection(int width, int height);
+
+	// Creates a scaler with given SLMController (using the board's index map, the modal basis and the phase correction if there are)
 	// Input: slmImg - array that will be storing scalled image to be initialized with 0's
 	//		  slmNum - index for board that will be scaling to, 0 based (defaults to 0)
 	// Output: returns scaler that will scale
@@ -0,0 +1,149 @@
+////////////////////
+// PhaseCorrection.cpp - implementation of PhaseCorrection class
+////////////////////
+
+#include "stdafx.h"
+#include "PhaseCorrection.h"
+#include "Utility.h"
+
+#include <cstring>	// memcpy()
+#include <fstream>	// reading LUT files
+#include <sstream>
+
+// Instruction set is chosen at compile time, AVX2 when building with /arch:AVX2 otherwise SSE2 (always present on x64)
+// SSE2 has no byte shuffle, so it only vectorizes the base phase addition and looks the LUT up per pixel
+// Define PHASE_CORRECTION_FORCE_SCALAR to use the plain C++ path
+#if !defined(PHASE_CORRECTION_FORCE_SCALAR) && defined(__AVX2__)
+#define PHASE_CORRECTION_AVX2
+#include <immintrin.h>
+#elif !defined(PHASE_CORRECTION_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PHASE_CORRECTION_SSE2
+#include <emmintrin.h>
+#endif
+
+PhaseCorrection::PhaseCorrection(int width, int height) {
+	this->width_ = width;
+	this->height_ = height;
+	for (int i = 0; i < 256; i++) {
+		this->lut_[i] = (unsigned char)i;
+	}
+	this->update();
+}
+
+void PhaseCorrection::update() {
+	this->identity_lut_ = true;
+	for (int i = 0; i < 256; i++) {
+		this->identity_lut_ = this->identity_lut_ && (this->lut_[i] == i);
+	}
+	this->idle_.clear();
+	if (!this->base_.empty()) {
+		this->idle_.resize(this->base_.size());
+		for (size_t p = 0; p < this->base_.size(); p++) {
+			this->idle_[p] = this->lut_[this->base_[p]];
+		}
+	}
+}
+
+bool PhaseCorrection::loadLUT(const std::string & path) {
+	std::ifstream file(path);
+	if (!file.is_open()) {
+		Utility::printLine("ERROR: could not open LUT file " + path);
+		return false;
+	}
+	unsigned char lut[256];
+	bool given[256] = { false };
+	int lineNumber = 0;
+	std::string line;
+	while (std::getline(file, line)) {
+		lineNumber++;
+		std::istringstream values(line);
+		int level, value;
+		if (!(values >> level)) {
+			continue; // Blank line
+		}
+		if (!(values >> value) || level < 0 || level > 255 || value < 0 || value > 255 || given[level]) {
+			Utility::printLine("ERROR: invalid line " + std::to_string(lineNumber) + " in LUT file " + path);
+			return false;
+		}
+		lut[level] = (unsigned char)value;
+		given[level] = true;
+	}
+	for (int i = 0; i < 256; i++) {
+		if (!given[i]) {
+			Utility::printLine("ERROR: LUT file " + path + " has no value for level " + std::to_string(i));
+			return false;
+		}
+	}
+	memcpy(this->lut_, lut, sizeof(lut));
+	this->update();
+	return true;
+}
+
+void PhaseCorrection::setBasePhase(const unsigned char * phase) {
+	if (phase == NULL) {
+		this->base_.clear();
+	}
+	else {
+		this->base_.assign(phase, phase + size_t(this->width_) * this->height_);
+	}
+	this->update();
+}
+
+// Add the base phase (bytes wrap around, which is the mod 2 pi), then look up the LUT
+void PhaseCorrection::apply(const unsigned char * phase_levels, unsigned char * frame, size_t first, size_t count) const {
+	unsigned char * out = frame + first;
+	const unsigned char * base = this->base_.empty() ? NULL : this->base_.data() + first;
+	size_t i = 0;
+#if defined(PHASE_CORRECTION_AVX2)
+	// The 256 entry LUT as 16 tables of 16 entries, looked up with a byte shuffle each.
+	// For table k the phase xor k * 16 is below 16 only where the high nibble is k, adding 0x70 with saturation
+	// sets the top bit everywhere else, which makes the shuffle give 0 there (the low nibble, the index, is kept)
+	__m256i tables[16];
+	for (int k = 0; k < 16; k++) {
+		tables[k] = _mm256_broadcastsi128_si256(_mm_loadu_si128((const __m128i*)(this->lut_ + k * 16)));
+	}
+	const __m256i outside = _mm256_set1_epi8(0x70);
+	for (; i + 32 <= count; i += 32) {
+		__m256i phase = _mm256_loadu_si256((const __m256i*)(phase_levels + i));
+		if (base != NULL) {
+			phase = _mm256_add_epi8(phase, _mm256_loadu_si256((const __m256i*)(base + i)));
+		}
+		if (!this->identity_lut_) {
+			__m256i value = _mm256_setzero_si256();
+			for (int k = 0; k < 16; k++) {
+				const __m256i index = _mm256_adds_epu8(_mm256_xor_si256(phase, _mm256_set1_epi8(char(k << 4))), outside);
+				value = _mm256_or_si256(value, _mm256_shuffle_epi8(tables[k], index));
+			}
+			phase = value;
+		}
+		_mm256_storeu_si256((__m256i*)(out + i), phase);
+	}
+#elif defined(PHASE_CORRECTION_SSE2)
+	if (base != NULL) {
+		for (; i + 16 <= count; i += 16) {
+			__m128i phase = _mm_add_epi8(_mm_loadu_si128((const __m128i*)(phase_levels + i)), _mm_loadu_si128((const __m128i*)(base + i)));
+			if (!this->identity_lut_) {
+				alignas(16) unsigned char levels[16];
+				_mm_store_si128((__m128i*)levels, phase);
+				for (int k = 0; k < 16; k++) {
+					levels[k] = this->lut_[levels[k]];
+				}
+				phase = _mm_load_si128((const __m128i*)levels);
+			}
+			_mm_storeu_si128((__m128i*)(out + i), phase);
+		}
+	}
+#endif
+	for (; i < count; i++) {
+		out[i] = this->lut_[(unsigned char)(phase_levels[i] + ((base != NULL) ? base[i] : 0))];
+	}
+}
+
+void PhaseCorrection::fillIdle(unsigned char * frame, size_t first, size_t count) const {
+	if (this->idle_.empty()) {
+		memset(frame + first, this->lut_[0], count);
+	}
+	else {
+		memcpy(frame + first, this->idle_.data() + first, count);
+	}
+}
@@ -0,0 +1,69 @@
+////////////////////
+// PhaseCorrection.h - software phase stage applied to scaled 8 bit SLM frames: static base phase, wrap and LUT in one pass
+////////////////////
+
+#ifndef PHASE_CORRECTION_H_
+#define PHASE_CORRECTION_H_
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// Turns the phase levels written by the scaler into the values sent to the SLM: value = lut[(phase + base) mod 256].
+// The base phase is a static pattern under the genome (system aberration, a tilt, or the best mask of a previous run),
+// the LUT maps phase to the drive value as a Blink .LUT file does in hardware (load a linear LUT in the board when using one here).
+class PhaseCorrection {
+private:
+	int width_, height_;
+	std::vector<unsigned char> base_;	// Base phase of each pixel, row major (empty for none)
+	unsigned char lut_[256];			// Drive value of each phase level
+	bool identity_lut_;					// lut_ is the identity (the lookup is skipped)
+	std::vector<unsigned char> idle_;	// lut_[base_] of each pixel, the value of pixels the scaler never writes
+
+	// Recompute idle_ and identity_lut_
+	void update();
+
+public:
+	// Constructor, identity LUT and no base phase
+	// Input: width, height - SLM image size in pixels
+	PhaseCorrection(int width, int height);
+
+	// Read a LUT file of "level value" lines (as the .LUT files of the Blink SDK), every level 0 to 255 must be given once
+	// Input: path - the file
+	// Output: false if the file could not be read or is invalid (reason printed, the LUT is unchanged)
+	bool loadLUT(const std::string & path);
+
+	// Set the base phase
+	// Input: phase - width * height phase levels, row major (NULL to remove the base phase)
+	void setBasePhase(const unsigned char * phase);
+
+	// True if the stage changes anything (a base phase or a LUT other than the identity)
+	bool isActive() const {
+		return !this->base_.empty() || !this->identity_lut_;
+	}
+
+	const int getWidth() const {
+		return this->width_;
+	}
+
+	const int getHeight() const {
+		return this->height_;
+	}
+
+	// Write the values of a span of phase levels into a frame
+	// Input:
+	//	phase_levels - count phase levels (may be frame + first to correct in place)
+	//	frame - the SLM image, first - index of the pixel phase_levels[0] is for, count - number of pixels
+	void apply(const unsigned char * phase_levels, unsigned char * frame, size_t first, size_t count) const;
+
+	// Write the value of a zero phase to a span of a frame (pixels no gene drives)
+	// Input: frame - the SLM image, first - index of the first pixel, count - number of pixels
+	void fillIdle(unsigned char * frame, size_t first, size_t count) const;
+
+	// Value of one pixel for a phase level
+	unsigned char correct(size_t pixel, unsigned int phase) const {
+		return this->lut_[(phase + (this->base_.empty() ? 0 : this->base_[pixel])) & 0xFF];
+	}
+};
+
+#endif
@@ -0,0 +1,52 @@
+////////////////////
+// PixelConvert.h - vectorized conversion of 16 bit camera pixels to the 8 bit scale used for fitness and display
+////////////////////
+
+#ifndef PIXEL_CONVERT_H_
+#define PIXEL_CONVERT_H_
+
+// Instruction set is chosen at compile time, AVX2 when building with /arch:AVX2 otherwise SSE2 (always present on x64)
+// Define PIXEL_CONVERT_FORCE_SCALAR to use the plain C++ path
+#if !defined(PIXEL_CONVERT_FORCE_SCALAR) && defined(__AVX2__)
+#define PIXEL_CONVERT_AVX2
+#include <immintrin.h>
+#elif !defined(PIXEL_CONVERT_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PIXEL_CONVERT_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace PixelConvert {
+	// x / 257 for every 16 bit x is (x * 0xFF01) >> 24, the high half of a 16 bit multiply then a shift by 8
+	const unsigned short DIV257_MULTIPLIER = 0xFF01;
+
+	// Scale 16 bit pixels down to 8 bits by dividing by 257 (65535 maps to 255, same as the former scalar loop)
+	// Input:
+	//	src - 16 bit pixels
+	//	dst - 8 bit pixels (may not overlap src)
+	//	count - number of pixels
+	inline void narrow16To8(const unsigned short * src, unsigned char * dst, int count) {
+		int i = 0;
+#if defined(PIXEL_CONVERT_AVX2)
+		const __m256i mul = _mm256_set1_epi16(short(DIV257_MULTIPLIER));
+		for (; i + 32 <= count; i += 32) {
+			const __m256i lo = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_loadu_si256((const __m256i*)(src + i)), mul), 8);
+			const __m256i hi = _mm256_srli_epi16(_mm256_mulhi_epu16(_mm256_loadu_si256((const __m256i*)(src + i + 16)), mul), 8);
+			// packus works within 128 bit lanes, reorder the quarters back to pixel order
+			_mm256_storeu_si256((__m256i*)(dst + i), _mm256_permute4x64_epi64(_mm256_packus_epi16(lo, hi), 0xD8));
+		}
+#elif defined(PIXEL_CONVERT_SSE2)
+		const __m128i mul = _mm_set1_epi16(short(DIV257_MULTIPLIER));
+		for (; i + 16 <= count; i += 16) {
+			const __m128i lo = _mm_srli_epi16(_mm_mulhi_epu16(_mm_loadu_si128((const __m128i*)(src + i)), mul), 8);
+			const __m128i hi = _mm_srli_epi16(_mm_mulhi_epu16(_mm_loadu_si128((const __m128i*)(src + i + 8)), mul), 8);
+			_mm_storeu_si128((__m128i*)(dst + i), _mm_packus_epi16(lo, hi));
+		}
+#endif
+		// Remaining pixels (all of them for the scalar path)
+		for (; i < count; i++) {
+			dst[i] = (unsigned char)((unsigned int)(src[i]) * DIV257_MULTIPLIER >> 24);
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,160 @@
+////////////////////
+// PixelTraits.h - camera pixel encodings the fitness functions read natively, with vectorized row sums
+////////////////////
+
+#ifndef PIXEL_TRAITS_H_
+#define PIXEL_TRAITS_H_
+
+#include <cstddef>	// size_t
+#include <cstdint>
+
+// Instruction set is chosen at compile time, AVX2 when building with /arch:AVX2 otherwise SSE2 (always present on x64)
+// Define PIXEL_SUM_FORCE_SCALAR to use the plain C++ path
+#if !defined(PIXEL_SUM_FORCE_SCALAR) && defined(__AVX2__)
+#define PIXEL_SUM_AVX2
+#include <immintrin.h>
+#elif !defined(PIXEL_SUM_FORCE_SCALAR) && (defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2))
+#define PIXEL_SUM_SSE2
+#include <emmintrin.h>
+#endif
+
+// Encoding of the pixel data of an ImageController (getPixelData())
+enum class PixelEncoding {
+	Mono8,	// One byte per pixel
+	Mono16,	// Two bytes per pixel (little endian)
+	Mono12p	// 12 bit pixels packed two to three bytes (GenICam Mono12p), image width must be even
+};
+
+// Tag type for 12 bit packed pixels (no C++ type holds one)
+struct Mono12Packed { };
+
+// Properties of a pixel type P (uint8_t, uint16_t or Mono12Packed)
+//	encoding - matching PixelEncoding
+//	max_value - full scale value, fitness values are normalized so this maps to 255 (the 8 bit scale the thresholds are set in)
+//	rowBytes(width) - bytes in a row of width pixels
+//	load(row, x) - value of pixel x of a row
+template <class P> struct PixelTraits { };
+
+template <> struct PixelTraits<uint8_t> {
+	static const PixelEncoding encoding = PixelEncoding::Mono8;
+	static const int max_value = 255;
+	static size_t rowBytes(int width) { return size_t(width); }
+	static unsigned int load(const unsigned char * row, int x) { return row[x]; }
+};
+
+template <> struct PixelTraits<uint16_t> {
+	static const PixelEncoding encoding = PixelEncoding::Mono16;
+	static const int max_value = 65535;
+	static size_t rowBytes(int width) { return size_t(width) * 2; }
+	static unsigned int load(const unsigned char * row, int x) { return reinterpret_cast<const uint16_t*>(row)[x]; }
+};
+
+template <> struct PixelTraits<Mono12Packed> {
+	static const PixelEncoding encoding = PixelEncoding::Mono12p;
+	static const int max_value = 4095;
+	static size_t rowBytes(int width) { return size_t(width) * 3 / 2; }
+	// Pixel pair k is bytes 3k to 3k + 2: even pixel = b0 | (b1 & 0xF) << 8, odd pixel = b1 >> 4 | b2 << 4
+	static unsigned int load(const unsigned char * row, int x) {
+		const unsigned char * b = row + 3 * (x >> 1);
+		return (x & 1) ? ((b[1] >> 4) | (unsigned(b[2]) << 4)) : (b[0] | (unsigned(b[1] & 0xF) << 8));
+	}
+};
+
+namespace PixelSum {
+	// Sum of the pixels x0 to x1 - 1 of a row
+	// Input:
+	//	row - start of the row
+	//	x0, x1 - pixel range (0 <= x0 <= x1 <= width)
+	// Output: the sum in the pixel type's own scale
+	template <class P>
+	uint64_t sumRow(const unsigned char * row, int x0, int x1);
+
+	template <>
+	inline uint64_t sumRow<uint8_t>(const unsigned char * row, int x0, int x1) {
+		const unsigned char * p = row + x0;
+		const int n = x1 - x0;
+		int i = 0;
+		uint64_t sum = 0;
+#if defined(PIXEL_SUM_AVX2)
+		// sad against zero adds each 8 bytes into a 64 bit lane
+		__m256i acc = _mm256_setzero_si256();
+		for (; i + 32 <= n; i += 32) {
+			acc = _mm256_add_epi64(acc, _mm256_sad_epu8(_mm256_loadu_si256((const __m256i*)(p + i)), _mm256_setzero_si256()));
+		}
+		const __m128i acc128 = _mm_add_epi64(_mm256_castsi256_si128(acc), _mm256_extracti128_si256(acc, 1));
+		sum = uint64_t(_mm_cvtsi128_si64(acc128)) + uint64_t(_mm_cvtsi128_si64(_mm_unpackhi_epi64(acc128, acc128)));
+#elif defined(PIXEL_SUM_SSE2)
+		__m128i acc = _mm_setzero_si128();
+		for (; i + 16 <= n; i += 16) {
+			acc = _mm_add_epi64(acc, _mm_sad_epu8(_mm_loadu_si128((const __m128i*)(p + i)), _mm_setzero_si128()));
+		}
+		sum = uint64_t(_mm_cvtsi128_si32(acc)) + uint64_t(_mm_cvtsi128_si32(_mm_unpackhi_epi64(acc, acc)));
+#endif
+		for (; i < n; i++) {
+			sum += p[i];
+		}
+		return sum;
+	}
+
+	template <>
+	inline uint64_t sumRow<uint16_t>(const unsigned char * row, int x0, int x1) {
+		const uint16_t * p = reinterpret_cast<const uint16_t*>(row) + x0;
+		const int n = x1 - x0;
+		int i = 0;
+		uint64_t sum = 0;
+		// Pixels are widened to 32 bit lanes, which can't overflow within a row (under 65537 additions per lane)
+#if defined(PIXEL_SUM_AVX2)
+		__m256i acc = _mm256_setzero_si256();
+		for (; i + 16 <= n; i += 16) {
+			const __m256i v = _mm256_loadu_si256((const __m256i*)(p + i));
+			acc = _mm256_add_epi32(acc, _mm256_unpacklo_epi16(v, _mm256_setzero_si256()));
+			acc = _mm256_add_epi32(acc, _mm256_unpackhi_epi16(v, _mm256_setzero_si256()));
+		}
+		uint32_t lanes[8];
+		_mm256_storeu_si256((__m256i*)lanes, acc);
+		for (int k = 0; k < 8; k++) {
+			sum += lanes[k];
+		}
+#elif defined(PIXEL_SUM_SSE2)
+		__m128i acc = _mm_setzero_si128();
+		for (; i + 8 <= n; i += 8) {
+			const __m128i v = _mm_loadu_si128((const __m128i*)(p + i));
+			acc = _mm_add_epi32(acc, _mm_unpacklo_epi16(v, _mm_setzero_si128()));
+			acc = _mm_add_epi32(acc, _mm_unpackhi_epi16(v, _mm_setzero_si128()));
+		}
+		uint32_t lanes[4];
+		_mm_storeu_si128((__m128i*)lanes, acc);
+		for (int k = 0; k < 4; k++) {
+			sum += lanes[k];
+		}
+#endif
+		for (; i < n; i++) {
+			sum += p[i];
+		}
+		return sum;
+	}
+
+	// Pixel pair k is bytes 3k to 3k + 2: even pixel = b0 | (b1 & 0xF) << 8, odd pixel = b1 >> 4 | b2 << 4
+	// Unpacked a pair at a time (SSE2 has no byte shuffle to unpack with)
+	template <>
+	inline uint64_t sumRow<Mono12Packed>(const unsigned char * row, int x0, int x1) {
+		uint64_t sum = 0;
+		int x = x0;
+		if ((x & 1) && x < x1) {
+			const unsigned char * b = row + 3 * (x >> 1);
+			sum += (b[1] >> 4) | (unsigned(b[2]) << 4);
+			x++;
+		}
+		for (; x + 2 <= x1; x += 2) {
+			const unsigned char * b = row + 3 * (x >> 1);
+			sum += (b[0] | (unsigned(b[1] & 0xF) << 8)) + ((b[1] >> 4) | (unsigned(b[2]) << 4));
+		}
+		if (x < x1) {
+			const unsigned char * b = row + 3 * (x >> 1);
+			sum += b[0] | (unsigned(b[1] & 0xF) << 8);
+		}
+		return sum;
+	}
+}
+
+#endif
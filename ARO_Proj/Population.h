@@ -7,16 +7,28 @@
 #define POPULATION_H_
 
 #include "Individual.h"
-#include "BetterRandom.h"	// Randomizer in generateRandomImage() & Crossover()
+#include "GenomeArena.h"	// Contiguous storage of the genomes
+#include "FastRandom.h"		// Randomizer in generateRandomImage() & Crossover()
+#include "CrossoverKernel.h"	// Vectorized crossover & mutation in Crossover()
 #include "Utility.h"		// For printLine() & rejoinClear() & generateRandomImage()
 
 #include "threadPool.h"
 
+#include <algorithm>	// std::sort() & std::nth_element() in RankIndividuals()
+
 template <class T>
 class Population {
 protected:
 	// The array of individuals in the population.
 	Individual<T>* individuals_;
+	// The array of individuals being built for the next generation (swapped with individuals_ by swapGenerations())
+	Individual<T>* next_individuals_;
+	// Reference counted storage for the genomes of both individuals_ and next_individuals_ (elites share a genome across generations)
+	GenomeArena<T>* arena_;
+	// Packed copy of the fitness of individuals_ used as the sort key when ranking (kept contiguous for the comparisons)
+	double * fitness_keys_;
+	// Ranking permutation set by RankIndividuals(), rank_[r] is the index into individuals_ of rank r (0 is worst, pop_size_-1 is best)
+	int * rank_;
 	// Number of individuals in the population.
 	int pop_size_;
 	// Number of individuals in the population that are to be kept as elite.
@@ -37,8 +49,15 @@ protected:
 	// Array to store results of crossovers to determine if a refresh is needed
 	bool * same_check;
 
-	// Pointer (or array if multithreading is used) of random number generator being used
-	BetterRandom * rng_machines;
+	// Array of random number generator streams, one per thread (just one if multithreading is not used)
+	FastRandom * rng_machines;
+	// Seed the streams were created from (reported so a run can be reproduced)
+	unsigned long long seed_;
+
+	// Chance for each gene of a child to mutate (when mutation is used in Crossover()), set with setMutationRate()
+	double mutation_rate_;
+	// 1/log(1 - mutation_rate_) used to draw the gap between mutated genes, 0 if mutation is disabled
+	double inv_log_keep_;
 
 public:
 	// Constructor
@@ -50,7 +69,8 @@ public:
 	//  multiThread:		 enable usage of multithreading (default true)
 	// _threadCount:		 when multithread is enabled, defines how many threads this population will use
 	//  myThreadPool:		 set the thread pool to be used when multithreading enabled
-	Population(int genome_length, int population_size, int elite_size, double accepted_similarity = .9, bool multiThread = true, int _threadCount = std::thread::hardware_concurrency(), threadPool * myThreadPool = NULL){
+	//  seed:				 seed for the random number generators (default 0, seeds from std::random_device)
+	Population(int genome_length, int population_size, int elite_size, double accepted_similarity = .9, bool multiThread = true, int _threadCount = std::thread::hardware_concurrency(), threadPool * myThreadPool = NULL, unsigned long long seed = 0){
 		this->genome_length_ = genome_length;
 		this->accepted_similarity_ = accepted_similarity;
 		this->pop_size_ = population_size;
@@ -58,37 +78,54 @@ public:
 		this->multiThread_ = multiThread;
 		this->threadCount_ = _threadCount;
 		this->myThreadPool_ = myThreadPool;
+		this->setMutationRate(1.0 / 200);
 
 		// Check to see if elite size exceeds the population size, currently just gives warning
 		if (this->elite_size_ > this->pop_size_) {
 			Utility::printLine("WARNING: Elite size (" + std::to_string(this->elite_size_) + ") of population exceeding population size (" + std::to_string(this->pop_size_) + ")!");
 		}
+		// Resolve the seed here so getSeed() always reports the one used
+		this->seed_ = (seed == 0) ? FastRandom::randomSeed() : seed;
 		if (this->multiThread_ == true) {
-			// Setting array of RNG machines to use with default cap
-			this->rng_machines = new BetterRandom[this->threadCount_];
+			// Setting array of RNG streams, one per thread
+			this->rng_machines = FastRandom::createStreams(this->seed_, this->threadCount_);
 
 			if (this->myThreadPool_ == NULL) {
 				Utility::printLine("ERROR: No thread pool set for population!");
 			}
 		}
 		else {
-			this->rng_machines = new BetterRandom[1];
+			this->rng_machines = FastRandom::createStreams(this->seed_, 1);
 		}
 
+		// Enough slots for a full current and next generation
+		this->arena_ = new GenomeArena<T>(this->genome_length_, 2 * this->pop_size_);
 		this->individuals_ = new Individual<T>[this->pop_size_];
+		this->next_individuals_ = new Individual<T>[this->pop_size_];
 		this->same_check = new bool[this->pop_size_ - this->elite_size_];
+		this->fitness_keys_ = new double[this->pop_size_];
+		this->rank_ = new int[this->pop_size_];
 
+		if (!this->arena_->isAllocated()) {
+			Utility::printLine("ERROR: Could not allocate the genomes of the population (" + std::to_string(this->pop_size_) + " individuals of " + std::to_string(this->genome_length_) + " genes)!");
+			return;
+		}
 		for (int i = 0; i < this->pop_size_; i++) {
-			this->individuals_[i].set_genome(Utility::generateRandomImage<T>(this->genome_length_, this->rng_machines));
+			this->individuals_[i].set_genome(this->arena_->acquire());
+			Utility::generateRandomImage<T>(this->individuals_[i].genome(), this->genome_length_, this->rng_machines);
 		}
 		Utility::printLine("INFO: Population created!");
 	}
 
-	//Destructor - delete individuals and call rejoinClear() to clear ind_threads
-	~Population() {
+	//Destructor - delete individuals and the arena holding their genomes (virtual, populations are deleted through base pointers)
+	virtual ~Population() {
 		delete[] this->individuals_;
+		delete[] this->next_individuals_;
+		delete this->arena_;
 		delete[] this->same_check;
-		delete[] this->rng_machines;
+		delete[] this->fitness_keys_;
+		delete[] this->rank_;
+		FastRandom::destroyStreams(this->rng_machines);
 	}
 
 	Individual<T> * getIndividual(int i) {
@@ -98,11 +135,50 @@ public:
 		return &this->individuals_[i];
 	}
 
+	// True if the genomes of the population could be allocated (the population must not be used otherwise)
+	const bool isAllocated() const {
+		return this->arena_->isAllocated();
+	}
+
 	// Get number of individuals in population
 	const int getSize() const {
 		return this->pop_size_;
 	}
 
+	// Get seed the random number generators of this population were created from
+	const unsigned long long getSeed() const {
+		return this->seed_;
+	}
+
+	// Get chance for each gene to mutate
+	const double getMutationRate() const {
+		return this->mutation_rate_;
+	}
+
+	// Set chance for each gene to mutate, clamped to [0,1] (0 disables mutation)
+	void setMutationRate(double rate) {
+		if (rate < 0 || rate > 1) {
+			Utility::printLine("WARNING: Mutation rate (" + std::to_string(rate) + ") outside of [0,1], clamping!");
+			rate = (rate < 0) ? 0 : 1;
+		}
+		this->mutation_rate_ = rate;
+		if (rate <= 0) {
+			this->inv_log_keep_ = 0;
+		}
+		else if (rate >= 1) {
+			// Every gene mutates, a tiny negative value makes every gap 0
+			this->inv_log_keep_ = -1e-300;
+		}
+		else {
+			this->inv_log_keep_ = 1.0 / std::log(1.0 - rate);
+		}
+	}
+
+	// Get number of genes in a genome
+	const int getGenomeLength() const {
+		return this->genome_length_;
+	}
+
 	// Get number of elite individuals in population
 	const int getEliteSize() const {
 		return this->elite_size_;
@@ -110,8 +186,8 @@ public:
 
 	// Getter for image of individual at inputted index
 	// Input: i - individual at given index (population not guranteed sorted)
-	// Output: the image for the individual
-	T * getGenome(int i) const {
+	// Output: the image for the individual (immutable, it may be shared with the next generation)
+	const T * getGenome(int i) const {
 		return this->individuals_[i].genome();
 	}
 
@@ -132,87 +208,94 @@ public:
 	}
 
 	// Crosses over information between individual genomes
+	//	Uses the vectorized kernel in CrossoverKernel.h, each gene has a 50% chance of coming from either parent
+	//	and (with mutation) a mutation_rate_ chance of being replaced by a random value
 	// Input:
 	//	a - First individual to be crossed over.
 	//	b - Second individual to be crossed over.
+	//	temp - genome to write the child into (a freshly acquired slot of the arena, see prepareNextGeneration())
 	//	same_check - boolean will be set to false if the arrays are different.
 	//  useMutation - boolean set if to perform mutation or not, defaults to true (enable).
-	// Output: returns new genome as result of crossover algorithm
-	T * Crossover(const T * a, const  T * b, bool& same_check, const bool useMutation, BetterRandom * rng_machine) const {
-		T * temp = new T[this->genome_length_];
-		double same_counter = 0; // counter keeping track of how many indices in the genomes are the same
-		// Variabales to hold results for easier readiblity or possible adjustments
-		bool choice, mutate;
-		T mutateVal;
-		// For each index in the genome
-		for (int i = 0; i < this->genome_length_; i++) {
-			// Set booleans
-			choice = ((100 * (*rng_machine)()) / RAND_MAX) < 50;
-			mutate = ((200 * (*rng_machine)()) / RAND_MAX) == 0;
-
-			// 50% chance of coming from either parent
-			if (choice) {
-				temp[i] = a[i];
-			}
-			else {
-				temp[i] = b[i];
-			}
-			// if the values at an index are the same, increment the same counter
-			if (a[i] == b[i])	{
-				same_counter += 1;
-			}
-			// mutation occuring if useMutation and at 0.05% chance
-			if (mutate && useMutation)	{
-				// Set mutate value
-				mutateVal = T(((256 * (*rng_machine)()) / RAND_MAX));
-				temp[i] = (T)mutateVal;
-			}
-		} // ... End image creation
+	// Output: temp holds the new genome as result of crossover algorithm
+	void Crossover(const T * a, const  T * b, T * temp, bool& same_check, const bool useMutation, FastRandom * rng_machine) const {
+		// counter keeping track of how many indices in the genomes are the same
+		const int same_counter = CrossoverKernel::blend(a, b, temp, this->genome_length_, rng_machine);
+
+		if (useMutation) {
+			CrossoverKernel::mutate(temp, this->genome_length_, this->inv_log_keep_, rng_machine);
+		}
 
 		// if the percentage of indices that are the same is less than the accepted similarity, label the two genomes as not the same (same_check = false)
-		same_counter /= this->genome_length_;
-		if (same_counter < this->accepted_similarity_) {
+		if (double(same_counter) / this->genome_length_ < this->accepted_similarity_) {
 			same_check = false;
 		}
-		return temp;
 	}
 
-	// Sorts an array of individuals
-	//		Currently (August 31 2021) this is using selection sort and shallow copies (the pointers get swapped, not the "actual" genome data)
+	// Ranks the individuals by fitness, filling rank_ with indices into individuals_ from worst to best
+	//	Genomes never move, only the permutation of indices is ordered (sorting on the packed fitness_keys_ array)
+	//	Ties are broken on the index so every population with the same fitness values ranks identically
 	// Input:
-	//	to_sort - the individuals to be sorted
-	//	size - the size of the array to_sort
-	// Output: the to_sort pointer now points to array of individuals that are sorted
-	void SortIndividuals(Individual<T> * to_sort, int size) {
-		int smallest_index = 0;
-
-		for (int i = 0; i < size - 1; i++) {
-			smallest_index = i;
-
-			for (int j = i + 1; j < size; j++)	{
-				if (to_sort[j].fitness() < to_sort[smallest_index].fitness()) {
-					smallest_index = j;
-				}
-			}
-			if (smallest_index != i) {
-				swapIndividuals(to_sort[i], to_sort[smallest_index]);
-			}
-		}
-	}
-
-	// Deep copies the genome & resulting image from one individual to another
+	//	sorted_count - number of best individuals that must be in exact order at the end of rank_
+	//				   (all others are only guaranteed to be ranked below them, found with nth_element)
+	// Output: rank_[pop_size_-1] is the index of the best individual, rank_[pop_size_-sorted_count..pop_size_-1] ordered
+	void RankIndividuals(int sorted_count) {
+		for (int i = 0; i < this->pop_size_; i++) {
+			this->fitness_keys_[i] = this->individuals_[i].fitness();
+			this->rank_[i] = i;
+		}
+		const double * keys = this->fitness_keys_;
+		auto lessFit = [keys](const int a, const int b) {
+			return keys[a] < keys[b] || (keys[a] == keys[b] && a < b);
+		};
+		// The best individual is always placed at the end
+		const int boundary = this->pop_size_ - (std::max)(sorted_count, 1);
+		if (boundary <= 0) {
+			std::sort(this->rank_, this->rank_ + this->pop_size_, lessFit);
+		}
+		else {
+			std::nth_element(this->rank_, this->rank_ + boundary, this->rank_ + this->pop_size_, lessFit);
+			std::sort(this->rank_ + boundary, this->rank_ + this->pop_size_, lessFit);
+		}
+	}
+
+	// Carries an individual into the next generation without copying, the genome is shared (reference counted) and fitness kept
+	// Genomes are never modified after they are written, so both generations can safely reference the same one
 	// Input:
-	//	to - the individual to be copied to
-	//	from - the individual copied
-	// Output: to is contains deep copy of from
-	void DeepCopyIndividual(Individual<T> & to, Individual<T> & from) const {
+	//	to - the individual in the next generation
+	//	from - the individual carried over
+	// Output: to references the genome of from and has its fitness
+	void CarryIndividual(Individual<T> & to, const Individual<T> & from) {
+		this->arena_->retain(from.genome());
+		to.set_genome(from.genome());
 		to.set_fitness(from.fitness());
-		T * temp_genome1 = new T[this->genome_length_];
-		T * temp_genome2 = from.genome();
-		for (int i = 0; i < this->genome_length_; i++) {
-			temp_genome1[i] = temp_genome2[i];
+	}
+
+	// Set up next_individuals_ at the start of nextGeneration() (after RankIndividuals())
+	//	Children (index below pop_size_ - elite_size_) get a fresh slot of the arena to be written once and fitness -1
+	//	Elites (the rest) are carried from the ranked individuals in rank order, so the best ends at pop_size_-1
+	// Called from the thread running nextGeneration() as the arena is not thread safe, workers then only write their children
+	void prepareNextGeneration() {
+		const int child_count = this->pop_size_ - this->elite_size_;
+		for (int i = 0; i < this->pop_size_; i++) {
+			if (i < child_count) {
+				this->next_individuals_[i].set_genome(this->arena_->acquire());
+				this->next_individuals_[i].set_fitness(-1);
+			}
+			else {
+				this->CarryIndividual(this->next_individuals_[i], this->individuals_[this->rank_[i]]);
+			}
 		}
-		to.set_genome(temp_genome1);
+	}
+
+	// Make the generation built in next_individuals_ the current one, called at the end of nextGeneration()
+	// The old generation releases its genomes, slots of individuals not carried over become free for the next children
+	void swapGenerations() {
+		for (int i = 0; i < this->pop_size_; i++) {
+			this->arena_->release(this->individuals_[i].genome());
+		}
+		Individual<T> * temp = this->individuals_;
+		this->individuals_ = this->next_individuals_;
+		this->next_individuals_ = temp;
 	}
 
 	// Perform the genetic algorithm to create new individuals for next gneeration
@@ -19,11 +19,14 @@ bool SGA_Optimization::setupInstanceVariables() {
 	// For threadCount, it is the number of threads in total allowed divided by number of boards
 	this->population.clear();
 	for (int i = 0; i < this->popCount; i++) {
-		this->population.push_back(new SGAPopulation<int>(this->cc->numberOfBinsY * this->cc->numberOfBinsX * this->cc->populationDensity,
-			this->populationSize, this->eliteSize, this->acceptedSimilarity, this->multithreadEnable, (this->gaPoolThreadCount / int(this->optBoards.size())), this->myThreadPool_));
+		this->population.push_back(new SGAPopulation<unsigned char>(genomeLength(i),
+			this->populationSize, this->eliteSize, this->acceptedSimilarity, this->multithreadEnable, (this->gaPoolThreadCount / int(this->optBoards.size())), this->myThreadPool_, this->rngSeed + i));
+		this->population[i]->setMutationRate(this->mutationRate);
+		if (!this->population[i]->isAllocated()) {
+			return false;
+		}
 	}
 
-	this->shortenExposureFlag = false;		// Set to true by individual if fitness is too high
 	this->stopConditionsMetFlag = false;	// Set to true if a stop condition was reached by one of the individuals
 	this->bestImage = NULL;
 	// Setup image displays for camera and SLM
@@ -57,7 +60,7 @@ bool SGA_Optimization::setupInstanceVariables() {
 	//Open up files to which progress will be logged
 	if (this->logAllFiles || this->saveTimeVSFitness) {
 		this->timePerGenFile.open(this->outputFolder + this->algorithm_name_ + "_timePerformance.txt");
-		this->timePerGenFile << "SGA Generation,Individuals Time (microseconds),NextGeneration Time (microseconds),Overall Generation Time (microseconds),";
+		this->timePerGenFile << "SGA Generation,Individuals Time (microseconds),NextGeneration Time (microseconds),Overall Generation Time (microseconds),Fitness Cache Hits,Fitness Cache Misses,Saved Hardware Evaluations (total),SLM Frames,";
 		// Also for easier tracking, outputing the thread counts as well
 		this->timePerGenFile << "Eval Individuals Threads," << this->indThreadCount << ",Next Generation Threads, " << this->gaPoolThreadCount << "\n";
 
@@ -9,7 +9,8 @@
 #include "GA_Optimization.h"
 #include "SGA_Population.h"
 
-class SGA_Optimization : public GA_Optimization {
+// Uses 8 bit genes (one phase value per bin), change the GA_Optimization argument for 16 bit SLMs
+class SGA_Optimization : public GA_Optimization<unsigned char> {
 	// Method to setup specific properties for SGA
 	bool setupInstanceVariables();
 
@@ -18,7 +19,7 @@ class SGA_Optimization : public GA_Optimization {
 
 public:
 	// Constructor - inherits from base class
-	SGA_Optimization(MainDialog* dlg, CameraController* cc, SLMController* sc) : GA_Optimization(dlg, cc, sc) {
+	SGA_Optimization(MainDialog* dlg, CameraController* cc, SLMController* sc) : GA_Optimization<unsigned char>(dlg, cc, sc) {
 		this->algorithm_name_ = "SGA";
 	};
 };
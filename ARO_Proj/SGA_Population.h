@@ -7,9 +7,15 @@
 #define SGAPOPULATION_H_
 
 #include "Population.h"
+#include "SelectionPolicy.h"	// RouletteSelector & AliasSelector for parent selection
 
-template <class T>
+// Selector - fitness proportionate selection policy (see SelectionPolicy.h), built once per generation
+template <class T, class Selector = RouletteSelector>
 class SGAPopulation : public Population<T> {
+private:
+	// Parent selection table, rebuilt at the start of nextGeneration() and shared read-only by all threads
+	Selector selector_;
+
 public:
 	// Constructor
 	// Input:
@@ -20,72 +26,54 @@ public:
 	//  multiThread:		 enable usage of multithreading (default true)
 	// _threadCount:		 when multithread is enabled, defines how many threads this population will use
 	//  myThreadPool:		 set the thread pool to be used when multithreading enabled
-	SGAPopulation(int genome_length, int population_size, int elite_size, double accepted_similarity = .9, bool multiThread = true, int _threadCount = std::thread::hardware_concurrency(), threadPool * myThreadPool = NULL)
-		: Population<T>(genome_length, population_size, elite_size, accepted_similarity, multiThread, _threadCount, myThreadPool) {};
+	//  seed:				 seed for the random number generators (default 0, seeds from std::random_device)
+	SGAPopulation(int genome_length, int population_size, int elite_size, double accepted_similarity = .9, bool multiThread = true, int _threadCount = std::thread::hardware_concurrency(), threadPool * myThreadPool = NULL, unsigned long long seed = 0)
+		: Population<T>(genome_length, population_size, elite_size, accepted_similarity, multiThread, _threadCount, myThreadPool, seed), selector_(population_size) {};
 
 	// Starts next generation using fitness of individuals.  Following the simple genetic algorithm approach.
 	bool nextGeneration() {
-		// Setting individuals to sorted (best is at end of the array)
-		SortIndividuals(this->individuals_, this->pop_size_);
+		// Rank individuals (best is at end of rank_), only the elites need to be in exact order
+		this->RankIndividuals(this->elite_size_);
 
-		// calculate total fitness of all individuals (necessary for fitness proportionate selection)
-		double fitness_sum = 0;
-		for (int i = 0; i < this->pop_size_; i++) {
-			fitness_sum += this->individuals_[i].fitness();
-		}
+		// Build the selection table over the ranked fitness (necessary for fitness proportionate selection)
+		this->selector_.build(this->fitness_keys_, this->rank_, this->pop_size_);
 
-		// Breeding
-		Individual<T> * temp = new Individual<T>[this->pop_size_];
+		// Breeding, elites are carried over and children get fresh genomes from the arena
+		this->prepareNextGeneration();
+		Individual<T> * temp = this->next_individuals_;
 		Individual<T> * pool = this->individuals_;
-		const double divisor = RAND_MAX / fitness_sum;
+		const int * rank = this->rank_;
+		const Selector * selector = &this->selector_;
 
 		// Lambda function to be used for generating new individual
 		// Input: i - index for new individual
 		// Captures:
 		//		temp			- pointer to array of individuals to store current new individual at temp[i]
-		//		divisor			- used in proportionate selection
-		//		individuals_	- access population genomes
+		//		selector		- selection table for fitness proportionate selection (read only)
+		//		pool			- access population genomes
+		//		rank			- ranking permutation from RankIndividuals()
 		//		this			- access Population instance for both RNG machine and Crossover method
 		// Output: temp[i] is set a new genome using crossover algorithm and mutation enabled
-		auto genInd = [temp, divisor, pool, this](int i, int threadID) {
+		auto genInd = [temp, selector, pool, rank, this](int i, int threadID) {
 
-			BetterRandom * myRNG = &this->rng_machines[threadID];
+			FastRandom * myRNG = &this->rng_machines[threadID];
 
 			this->same_check[i] = true;
-			// select first parent with fitness proportionate selection and store associated genome into temp_image1
-			double selected = (*myRNG)() / divisor;
-			double temp_sum = pool[0].fitness(); // Recall 0 index has worst fitness
-			int j = 0;
-			while (temp_sum < selected) {
-				j++;
-				temp_sum += pool[j].fitness();
-			}
-			const T * parent1 = pool[j].genome();
-
-			// Select second parent with fitness proportionate selection and store associated genome into temp_image2
-			selected = (*myRNG)() / divisor;
-			temp_sum = pool[0].fitness();
-			j = 0;
-			while (temp_sum < selected) {
-				j++;
-				temp_sum += pool[j].fitness();
-			}
-			const T * parent2 = pool[j].genome();
+			// select both parents with fitness proportionate selection
+			const T * parent1 = pool[rank[selector->select(myRNG->uniform())]].genome();
+			const T * parent2 = pool[rank[selector->select(myRNG->uniform())]].genome();
 
 			// perform crossover with mutation
-			temp[i].set_genome(this->Crossover(parent1, parent2, same_check[i], true, myRNG));
+			this->Crossover(parent1, parent2, temp[i].genome(), this->same_check[i], true, myRNG);
 		}; // ... genInd(i)
 
 		// Lambda function for multithreading to perform generation of next pool with fewer given threads
 		// Input: threadID - current thread index
 		//		  numThreads - total number of threads being launched
 		//        pop_size_ - passed in to reduce false sharing, the number of individuals in pool/temp
-		//		  elite_size - passed in to reduce false sharing, the number of elites to carry over
-		// Captures: temp - array of individuals to store results into
-		//			pool - array of current individuals to get parents from
-		//			divisor - value used in conjunction with parent_selector to select individual (used in genInd) and captured by reference
-		//			this - pointer to current population instance for instance of DeepCopyIndividual
-		auto genSubGroup = [temp, pool, divisor, genInd, this](const int threadID, const int numThreads, const int pop_size_, const int elite_size_) {
+		//		  elite_size - passed in to reduce false sharing, the number of elites (skipped, already carried over)
+		// Captures: genInd - lambda producing a new individual
+		auto genSubGroup = [genInd](const int threadID, const int numThreads, const int pop_size_, const int elite_size_) {
 			int groupSize = pop_size_ / numThreads;
 			int remainder = pop_size_ - groupSize*numThreads;
 			int start_index = threadID*groupSize;
@@ -100,13 +88,10 @@ public:
 				}
 			}
 			for (int id = start_index; id < start_index + groupSize && id < pop_size_; id++) {
+				// Produce New Individuals (elites were already carried by prepareNextGeneration())
 				if (id < (pop_size_ - elite_size_)) {
-					// Produce New Individuals
 					genInd(id, threadID);
 				}
-				else { // Carry Elites
-					this->DeepCopyIndividual(temp[id], pool[id]);
-				}
 			}
 		}; // .. genSubGroup
 
@@ -118,14 +103,8 @@ public:
 		}
 		else { // Serial
 			// Produce New Individuals
-			for (int id = 0; id < this->pop_size_; id++) {
-				if (id < (this->pop_size_ - this->elite_size_)) {
-					// Produce New Individuals
-					genInd(id, 0);
-				}
-				else { // Carry Elites
-					this->DeepCopyIndividual(temp[id], pool[id]);
-				}
+			for (int id = 0; id < (this->pop_size_ - this->elite_size_); id++) {
+				genInd(id, 0);
 			}
 		}
 
@@ -140,10 +119,12 @@ public:
 
 		// if all of our individuals are labeled similar, replace half of them with new images
 		if (same_check_result) {
+			// Only children are refreshed, the elites share their genome with the previous generation (see CarryIndividual())
+			const int refresh_count = (std::min)(this->pop_size_ / 2, this->pop_size_ - this->elite_size_);
 			// Lambda function to capture thread behavior
 			// Input: threadID - current thread
 			//		  numThreads - total number of threads being launched
-			//		  pop_size - population size to be randomizing
+			//		  pop_size - number of individuals to be randomizing (from index 0)
 			//		  genome_length - size of the individual images to randomly generate with
 			// Captures - temp - array of individuals to store new random genomes within
 			auto randSubGroup = [temp, this](const int threadID, const int numThreads, int pop_size, int genome_length) {
@@ -160,28 +141,27 @@ public:
 						start_index += remainder;
 					}
 				}
-				for (int id = start_index; id < start_index + groupSize && id < pop_size / 2; id++) {
-					temp[id].set_genome(Utility::generateRandomImage<T>(genome_length, &this->rng_machines[threadID]));
+				for (int id = start_index; id < start_index + groupSize && id < pop_size; id++) {
+					Utility::generateRandomImage<T>(temp[id].genome(), genome_length, &this->rng_machines[threadID]);
 				}
 			}; // .. randSubGroup
 
 			// Calling generate random image for half of pop individuals
 			if (this->multiThread_ == true) {
 				for (int i = 0; i < this->threadCount_; i++) {
-					this->myThreadPool_->pushJob(std::bind(randSubGroup, i, this->threadCount_, this->pop_size_ / 2, this->genome_length_));
+					this->myThreadPool_->pushJob(std::bind(randSubGroup, i, this->threadCount_, refresh_count, this->genome_length_));
 				}
 				this->myThreadPool_->wait();
 			}
 			else {
-				for (int i = 0; i < this->pop_size_ / 2; i++) {
-					temp[i].set_genome(Utility::generateRandomImage<T>(this->genome_length_, this->rng_machines));
+				for (int i = 0; i < refresh_count; i++) {
+					Utility::generateRandomImage<T>(temp[i].genome(), this->genome_length_, this->rng_machines);
 				}
 			}
 		}
 
-		// Assign new population to individuals_
-		delete[] this->individuals_;
-		this->individuals_ = temp;
+		// Swap the new population into individuals_ (no genomes are deleted, the old front becomes the next back buffer)
+		this->swapGenerations();
 		return true; // No issues!
 	}	// ... Function nextGeneration
 
@@ -0,0 +1,206 @@
+////////////////////
+// SLMFrameBank.h - stages a whole generation of SLM frames in board RAM so each evaluation only selects a frame
+////////////////////
+
+#ifndef SLM_FRAME_BANK_H_
+#define SLM_FRAME_BANK_H_
+
+#include <vector>
+#include <cstring>	// memset()
+#include <cmath>	// abs()
+
+#include "Utility.h"	// printLine()
+
+// Holds up to capacity frames for each board being optimized.
+// Frames are scaled into host buffers (frame()), given to the boards with upload(), then shown one at a time with select().
+// By default select() writes the frame with Write_image, the documented single image path.
+// The Blink SDK has no documented multi-frame bank (Write_cal_buffer is marked deprecated and Select_cal_frame is not documented
+// to pick frames by index), so the frames are only treated as resident once upload() verified it: two known slots are shown both
+// from board RAM (Select_cal_frame) and with Write_image, and each must measure closer to its own reference than to the other's.
+// If a board rejects the buffer or the measurements disagree the bank keeps writing frames individually for the rest of the run.
+// Not thread safe, upload() and select() are called from the thread using the hardware (frame() buffers may be filled by any thread).
+// SDK - class with the Blink_SDK surface used here (Write_cal_buffer, Select_cal_frame, Write_image), see SLMFrameBankCheck.h for a stand-in
+template <class SDK>
+class SLMFrameBank {
+private:
+	SDK * sdk_;
+	// Number of frames per board
+	int capacity_;
+	// For each board: 1 based board id, bytes per frame, image size given to Write_image and the frames (capacity_ frames back to back)
+	std::vector<int> board_ids_;
+	std::vector<size_t> frame_bytes_;
+	std::vector<unsigned int> image_sizes_;
+	std::vector<unsigned char*> frames_;
+	// True if the frames of the last upload() are in board RAM (select() only switches frames)
+	bool resident_;
+	// True once Select_cal_frame was verified to show the frame of the given slot
+	bool verified_;
+	// True once a board rejected an upload or failed verification, later uploads are skipped and frames are written individually
+	bool rejected_;
+
+	// Write the frame of a slot to every board with Write_image
+	bool writeSlot(int slot) {
+		bool result = true;
+		for (int i = 0; i < this->board_ids_.size(); i++) {
+			result = this->sdk_->Write_image(this->board_ids_[i], this->frame(i, slot), this->image_sizes_[i], false, false, 0) && result;
+		}
+		return result;
+	}
+
+	// Show the frame of a slot on every board from board RAM with Select_cal_frame
+	bool selectSlot(int slot) {
+		bool result = true;
+		for (int i = 0; i < this->board_ids_.size(); i++) {
+			result = this->sdk_->Select_cal_frame(this->board_ids_[i], slot) && result;
+		}
+		return result;
+	}
+
+	// Give up on the bank for the rest of the run
+	void reject(const std::string & reason) {
+		this->resident_ = false;
+		this->rejected_ = true;
+		Utility::printLine("WARNING: " + reason + ", writing SLM frames individually");
+	}
+
+	// Check that selecting the first and last uploaded slots from board RAM shows those frames
+	// Input:
+	//	count - number of slots filled
+	//	measure - see upload()
+	// Output: 1 if verified, 0 if the check could not tell (frames measure alike or a measurement failed), -1 if it failed
+	template <class Measure>
+	int verify(int count, Measure & measure) {
+		const int slots[2] = { 0, count - 1 };
+		double reference[2], selected[2];
+		for (int k = 0; k < 2; k++) {
+			if (!this->writeSlot(slots[k])) {
+				return 0;
+			}
+			reference[k] = measure();
+			if (!this->selectSlot(slots[k])) {
+				return -1;
+			}
+			selected[k] = measure();
+			if (reference[k] < 0 || selected[k] < 0) {
+				return 0;
+			}
+		}
+		if (reference[0] == reference[1]) {
+			return 0;
+		}
+		for (int k = 0; k < 2; k++) {
+			if (std::abs(selected[k] - reference[k]) >= std::abs(selected[k] - reference[1 - k])) {
+				return -1;
+			}
+		}
+		return 1;
+	}
+
+public:
+	// Constructor
+	// Input:
+	//	sdk - the SDK controlling the boards (not owned)
+	//	capacity - number of frames per board (the population size)
+	SLMFrameBank(SDK * sdk, int capacity) {
+		this->sdk_ = sdk;
+		this->capacity_ = capacity;
+		this->resident_ = false;
+		this->verified_ = false;
+		this->rejected_ = false;
+	}
+
+	// Destructor - frees the frame buffers
+	~SLMFrameBank() {
+		for (int i = 0; i < this->frames_.size(); i++) {
+			delete[] this->frames_[i];
+		}
+	}
+
+	SLMFrameBank(const SLMFrameBank & other) = delete;
+	SLMFrameBank& operator=(const SLMFrameBank & other) = delete;
+
+	// Add a board to the bank, boards are then referred to by the order they were added in
+	// Input:
+	//	board_id - 1 based index of the board for the SDK
+	//	frame_bytes - size of a frame for the board
+	//	image_size - board width or height as given to Write_image (square SLM)
+	void addBoard(int board_id, size_t frame_bytes, unsigned int image_size) {
+		this->board_ids_.push_back(board_id);
+		this->frame_bytes_.push_back(frame_bytes);
+		this->image_sizes_.push_back(image_size);
+		unsigned char * frames = new unsigned char[frame_bytes * this->capacity_];
+		// Zero so the area outside the bins of a scaled genome is deterministic
+		memset(frames, 0, frame_bytes * this->capacity_);
+		this->frames_.push_back(frames);
+	}
+
+	// Host buffer of a frame, to be written before upload()
+	// Input:
+	//	board - index of the board in the order added
+	//	slot - frame index (0 to capacity - 1)
+	unsigned char * frame(int board, int slot) {
+		return this->frames_[board] + this->frame_bytes_[board] * slot;
+	}
+
+	// Send the frames of every board to board RAM, verifying the first time that selecting a slot shows its frame
+	// Input:
+	//	count - number of slots filled (verification needs at least two)
+	//	measure - called with no arguments after a frame is shown on every board, returns a measurement of what is shown
+	//			  (the fitness of a camera image), negative if it failed
+	// Output: true if the frames are resident and select() only switches frames, false if select() writes frames individually
+	template <class Measure>
+	bool upload(int count, Measure measure) {
+		this->resident_ = false;
+		if (this->rejected_ || (!this->verified_ && count < 2)) {
+			return false;
+		}
+		for (int i = 0; i < this->board_ids_.size(); i++) {
+			if (!this->sdk_->Write_cal_buffer(this->board_ids_[i], this->frames_[i])) {
+				this->reject("SLM did not accept frame bank upload");
+				return false;
+			}
+		}
+		if (!this->verified_) {
+			const int result = this->verify(count, measure);
+			if (result < 0) {
+				this->reject("Selected SLM frame bank slots did not match their frames");
+				return false;
+			}
+			if (result == 0) {
+				// Try again with the next upload
+				return false;
+			}
+			this->verified_ = true;
+			Utility::printLine("INFO: Verified SLM frame bank, selecting frames from board RAM");
+		}
+		this->resident_ = true;
+		return true;
+	}
+
+	// Show a frame on every board
+	// Input: slot - frame index (0 to capacity - 1)
+	// Output: true if no errors
+	bool select(int slot) {
+		if (this->resident_) {
+			return this->selectSlot(slot);
+		}
+		return this->writeSlot(slot);
+	}
+
+	// True if the frames are in board RAM (the last upload() succeeded)
+	const bool isResident() const {
+		return this->resident_;
+	}
+
+	// Number of frames per board
+	const int getCapacity() const {
+		return this->capacity_;
+	}
+
+	// Number of boards in the bank
+	const int getBoardCount() const {
+		return int(this->board_ids_.size());
+	}
+};
+
+#endif
@@ -0,0 +1,141 @@
+////////////////////
+// SLMFrameBankCheck.h - stand-in for the Blink SDK and a check of the SLMFrameBank upload, select and fallback paths
+////////////////////
+
+#ifndef SLM_FRAME_BANK_CHECK_H_
+#define SLM_FRAME_BANK_CHECK_H_
+
+#include <vector>
+#include <cstring>	// memcpy(), memset()
+
+#include "SLMFrameBank.h"
+#include "Utility.h"	// printLine()
+
+// Simulated boards with the Blink_SDK surface SLMFrameBank uses, each board keeps the frame it shows and a RAM buffer of frames
+struct StandInSLM_SDK {
+	// How the boards respond to Write_cal_buffer and Select_cal_frame
+	enum BankMode {
+		Resident,		// Frames are kept and selected by index
+		Rejects,		// Write_cal_buffer fails
+		IgnoresIndex	// Write_cal_buffer succeeds but Select_cal_frame always shows the first frame
+	};
+	BankMode mode;
+	size_t frame_bytes;
+	int capacity;
+	std::vector<std::vector<unsigned char>> ram, shown;
+	// Number of calls, to tell which path showed a frame
+	int cal_writes, selects, image_writes;
+
+	// Input: boards - number of boards (1 based ids), frame_bytes - size of a frame, capacity - frames per board, mode - see BankMode
+	StandInSLM_SDK(int boards, size_t frame_bytes, int capacity, BankMode mode) {
+		this->mode = mode;
+		this->frame_bytes = frame_bytes;
+		this->capacity = capacity;
+		this->ram = std::vector<std::vector<unsigned char>>(boards, std::vector<unsigned char>(frame_bytes * capacity, 0));
+		this->shown = std::vector<std::vector<unsigned char>>(boards, std::vector<unsigned char>(frame_bytes, 0));
+		this->cal_writes = 0;
+		this->selects = 0;
+		this->image_writes = 0;
+	}
+
+	bool Write_cal_buffer(int board, const unsigned char* buffer) {
+		this->cal_writes++;
+		if (this->mode == Rejects) {
+			return false;
+		}
+		memcpy(this->ram[board - 1].data(), buffer, this->frame_bytes * this->capacity);
+		return true;
+	}
+
+	bool Select_cal_frame(int board, int frame) {
+		this->selects++;
+		const int shownFrame = (this->mode == IgnoresIndex) ? 0 : frame;
+		memcpy(this->shown[board - 1].data(), this->ram[board - 1].data() + this->frame_bytes * shownFrame, this->frame_bytes);
+		return true;
+	}
+
+	bool Write_image(int board, const unsigned char* image, unsigned int image_size, bool wait_for_trigger = false, bool external_pulse = false, unsigned int trigger_timeout_ms = 0) {
+		this->image_writes++;
+		memcpy(this->shown[board - 1].data(), image, this->frame_bytes);
+		return true;
+	}
+
+	// Stand-in for the camera, sum of the pixels shown on every board
+	double measure() const {
+		double sum = 0;
+		for (int i = 0; i < this->shown.size(); i++) {
+			for (int j = 0; j < this->frame_bytes; j++) {
+				sum += this->shown[i][j];
+			}
+		}
+		return sum;
+	}
+};
+
+// Run the frame bank against the stand-in SDK in each mode and check every frame selected is the one shown
+// Output: true if every path behaved, otherwise false with the failing path printed as an ERROR
+inline bool checkSLMFrameBank() {
+	const int boards = 2, capacity = 4, count = 3;
+	const size_t frameBytes = 16;
+	const StandInSLM_SDK::BankMode modes[3] = { StandInSLM_SDK::Resident, StandInSLM_SDK::Rejects, StandInSLM_SDK::IgnoresIndex };
+	const char * modeNames[3] = { "resident", "rejected upload", "ignored frame index" };
+	bool passed = true;
+	for (int m = 0; m < 3; m++) {
+		StandInSLM_SDK sdk(boards, frameBytes, capacity, modes[m]);
+		SLMFrameBank<StandInSLM_SDK> bank(&sdk, capacity);
+		for (int i = 0; i < boards; i++) {
+			bank.addBoard(i + 1, frameBytes, 4);
+		}
+		auto measure = [&sdk]() { return sdk.measure(); };
+		auto fail = [&passed, &modeNames, m](const std::string & what) {
+			Utility::printLine("ERROR: SLM frame bank check (" + std::string(modeNames[m]) + "): " + what);
+			passed = false;
+		};
+
+		// Before any upload frames are written individually
+		bank.select(0);
+		if (sdk.image_writes != boards || sdk.selects != 0) {
+			fail("select() before upload() did not write the frame");
+		}
+
+		// Frames that measure alike cannot be verified, the bank stays on Write_image without giving up
+		if (bank.upload(count, measure)) {
+			fail("identical frames were taken as verified");
+		}
+
+		// Distinct frames, slot k of board i filled with k + i + 1
+		for (int i = 0; i < boards; i++) {
+			for (int slot = 0; slot < count; slot++) {
+				memset(bank.frame(i, slot), slot + i + 1, frameBytes);
+			}
+		}
+		const bool resident = bank.upload(count, measure);
+		if (resident != (modes[m] == StandInSLM_SDK::Resident) || resident != bank.isResident()) {
+			fail("upload() returned " + std::to_string(resident));
+		}
+		for (int slot = count - 1; slot >= 0; slot--) {
+			const int selects = sdk.selects, writes = sdk.image_writes;
+			if (!bank.select(slot)) {
+				fail("select() failed");
+			}
+			for (int i = 0; i < boards; i++) {
+				if (sdk.shown[i][0] != slot + i + 1) {
+					fail("slot " + std::to_string(slot) + " of board " + std::to_string(i + 1) + " was not shown");
+				}
+			}
+			if (resident ? (sdk.image_writes != writes) : (sdk.selects != selects)) {
+				fail("select() used the wrong path");
+			}
+		}
+
+		// A rejected bank skips later uploads
+		const int calWrites = sdk.cal_writes;
+		const bool again = bank.upload(count, measure);
+		if (again != resident || (!resident && sdk.cal_writes != calWrites)) {
+			fail("second upload() returned " + std::to_string(again));
+		}
+	}
+	return passed;
+}
+
+#endif
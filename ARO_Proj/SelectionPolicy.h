@@ -0,0 +1,181 @@
+////////////////////
+// SelectionPolicy.h - fitness proportionate parent selection engines used by the genetic algorithm populations
+////////////////////
+
+#ifndef SELECTION_POLICY_H_
+#define SELECTION_POLICY_H_
+
+#include <algorithm>	// std::upper_bound()
+
+// A selection policy is built once per generation from the fitness of the pool and is then sampled read-only,
+// so any number of worker threads can draw parents from the same table without locking.
+// Interface expected by the populations:
+//	Policy(int capacity)						- allocate for up to capacity individuals
+//	void build(const double * weights, const int * order, int count)
+//												- weights[order[r]] is the weight of rank r, count individuals
+//	int select(double u) const					- u uniform in [0,1), returns a rank in [0,count)
+// A pool where every weight is zero (or the total is not positive) falls back to uniform selection.
+
+// Roulette wheel selection on a prefix sum of the weights
+//	build is O(n), select is a binary search O(log n)
+class RouletteSelector {
+private:
+	// cumulative_[r] is the sum of the weights of ranks 0..r
+	double * cumulative_;
+	int capacity_;
+	int count_;
+	// True if the total weight was not positive and selection is uniform
+	bool uniform_;
+
+public:
+	RouletteSelector(int capacity) {
+		this->capacity_ = capacity;
+		this->count_ = 0;
+		this->uniform_ = true;
+		this->cumulative_ = new double[capacity];
+	}
+
+	~RouletteSelector() {
+		delete[] this->cumulative_;
+	}
+
+	RouletteSelector(const RouletteSelector & other) = delete;
+	RouletteSelector& operator=(const RouletteSelector & other) = delete;
+
+	// Build the prefix sum for this generation
+	// Input:
+	//	weights - fitness of each individual (negative weights are treated as 0)
+	//	order	- ranking permutation, weights[order[r]] is the weight of rank r
+	//	count	- number of individuals (no more than capacity)
+	void build(const double * weights, const int * order, int count) {
+		this->count_ = count;
+		double sum = 0;
+		for (int r = 0; r < count; r++) {
+			const double w = weights[order[r]];
+			if (w > 0) {
+				sum += w;
+			}
+			this->cumulative_[r] = sum;
+		}
+		this->uniform_ = !(sum > 0);
+	}
+
+	// Select a rank
+	// Input: u - uniform random value in [0,1)
+	// Output: rank r chosen with probability weight(r)/total
+	int select(double u) const {
+		if (this->uniform_) {
+			return (std::min)(int(u * this->count_), this->count_ - 1);
+		}
+		const double target = u * this->cumulative_[this->count_ - 1];
+		// First rank whose cumulative weight exceeds the target, so zero weight ranks are never picked
+		const int r = int(std::upper_bound(this->cumulative_, this->cumulative_ + this->count_, target) - this->cumulative_);
+		return (std::min)(r, this->count_ - 1);
+	}
+};
+
+// Walker/Vose alias table selection
+//	build is O(n), select is O(1) (one column lookup and one comparison)
+class AliasSelector {
+private:
+	// prob_[c] is the chance of keeping column c, otherwise alias_[c] is selected
+	double * prob_;
+	int * alias_;
+	// Work lists used while building the table
+	int * small_;
+	int * large_;
+	double * scaled_;
+	int capacity_;
+	int count_;
+
+public:
+	AliasSelector(int capacity) {
+		this->capacity_ = capacity;
+		this->count_ = 0;
+		this->prob_ = new double[capacity];
+		this->alias_ = new int[capacity];
+		this->small_ = new int[capacity];
+		this->large_ = new int[capacity];
+		this->scaled_ = new double[capacity];
+	}
+
+	~AliasSelector() {
+		delete[] this->prob_;
+		delete[] this->alias_;
+		delete[] this->small_;
+		delete[] this->large_;
+		delete[] this->scaled_;
+	}
+
+	AliasSelector(const AliasSelector & other) = delete;
+	AliasSelector& operator=(const AliasSelector & other) = delete;
+
+	// Build the alias table for this generation (Vose's method)
+	// Input:
+	//	weights - fitness of each individual (negative weights are treated as 0)
+	//	order	- ranking permutation, weights[order[r]] is the weight of rank r
+	//	count	- number of individuals (no more than capacity)
+	void build(const double * weights, const int * order, int count) {
+		this->count_ = count;
+		double sum = 0;
+		for (int r = 0; r < count; r++) {
+			const double w = weights[order[r]];
+			this->scaled_[r] = (w > 0) ? w : 0;
+			sum += this->scaled_[r];
+		}
+		// Uniform fallback, every column keeps itself
+		if (!(sum > 0)) {
+			for (int r = 0; r < count; r++) {
+				this->prob_[r] = 1;
+				this->alias_[r] = r;
+			}
+			return;
+		}
+		int small_count = 0, large_count = 0;
+		for (int r = 0; r < count; r++) {
+			this->scaled_[r] *= count / sum;
+			if (this->scaled_[r] < 1) {
+				this->small_[small_count++] = r;
+			}
+			else {
+				this->large_[large_count++] = r;
+			}
+		}
+		while (small_count > 0 && large_count > 0) {
+			const int s = this->small_[--small_count];
+			const int l = this->large_[--large_count];
+			this->prob_[s] = this->scaled_[s];
+			this->alias_[s] = l;
+			this->scaled_[l] = (this->scaled_[l] + this->scaled_[s]) - 1;
+			if (this->scaled_[l] < 1) {
+				this->small_[small_count++] = l;
+			}
+			else {
+				this->large_[large_count++] = l;
+			}
+		}
+		// Whatever remains is 1 up to rounding error
+		while (large_count > 0) {
+			const int l = this->large_[--large_count];
+			this->prob_[l] = 1;
+			this->alias_[l] = l;
+		}
+		while (small_count > 0) {
+			const int s = this->small_[--small_count];
+			this->prob_[s] = 1;
+			this->alias_[s] = s;
+		}
+	}
+
+	// Select a rank
+	// Input: u - uniform random value in [0,1), the integer part of u*count picks the column and the fraction the coin
+	// Output: rank r chosen with probability weight(r)/total
+	int select(double u) const {
+		const double scaled = u * this->count_;
+		const int column = (std::min)(int(scaled), this->count_ - 1);
+		const double coin = scaled - column;
+		return (coin < this->prob_[column]) ? column : this->alias_[column];
+	}
+};
+
+#endif
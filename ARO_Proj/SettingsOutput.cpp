@@ -114,6 +114,70 @@ bool MainDialog::setValueByName(std::string name, std::string value) {
 	else if (name == "multithreading") {
 		this->m_MultiThreadEnable.SetCheck(value == "true");
 	}
+	else if (name == "rngSeed") {
+		this->rngSeed_ = std::stoull(value);
+	}
+	else if (name == "slmFrameBank") {
+		this->slmFrameBank_ = (value == "true");
+	}
+	else if (name == "syncAcquisition") {
+		this->syncAcquisition_ = (value == "true");
+	}
+	else if (name == "slmSettleTime") {
+		this->slmSettleTime_ = std::stod(value);
+	}
+	else if (name == "useFitnessCache") {
+		this->useFitnessCache_ = (value == "true");
+	}
+	else if (name == "fitnessCacheTTL") {
+		const int ttl = std::stoi(value);
+		if (ttl < 1) {
+			return false;
+		}
+		this->fitnessCacheTTL_ = ttl;
+	}
+	else if (name == "fitnessFunction") {
+		this->fitnessFunction_ = std::stoi(value);
+	}
+	else if (name == "targetOffsetX") {
+		this->targetOffsetX_ = std::stod(value);
+	}
+	else if (name == "targetOffsetY") {
+		this->targetOffsetY_ = std::stod(value);
+	}
+	else if (name == "targetAspect") {
+		this->targetAspect_ = std::stod(value);
+	}
+	else if (name == "targetSpots") {
+		this->targetSpots_ = value;
+	}
+	else if (name == "targetAggregator") {
+		this->targetAggregator_ = std::stoi(value);
+	}
+	else if (name == "slmSegmentation") {
+		this->slmSegmentation_ = std::stoi(value);
+	}
+	else if (name == "slmPupilRadius") {
+		this->slmPupilRadius_ = std::stod(value);
+	}
+	else if (name == "slmIndexMapFile") {
+		this->slmIndexMapFile_ = value;
+	}
+	else if (name == "optimizationBasis") {
+		this->optimizationBasis_ = std::stoi(value);
+	}
+	else if (name == "basisModes") {
+		this->basisModes_ = std::stoi(value);
+	}
+	else if (name == "basisAmplitude") {
+		this->basisAmplitude_ = std::stod(value);
+	}
+	else if (name == "softwareLUTFile") {
+		this->softwareLUTFile_ = value;
+	}
+	else if (name == "basePhaseFile") {
+		this->basePhaseFile_ = value;
+	}
 	else if (name == "algorithm") {
 		switch (OptType(std::stoi(value))) {
 		case(OptType::IA) :
@@ -125,6 +189,9 @@ bool MainDialog::setValueByName(std::string name, std::string value) {
 		case(OptType::uGA) :
 			this->OnBnClickedUgaButton();
 			break;
+		case(OptType::SSGA) :
+			this->OnBnClickedSsgaButton();
+			break;
 		}
 	}
 
@@ -168,6 +235,13 @@ bool MainDialog::setValueByName(std::string name, std::string value) {
 	else if (name == "skipEliteReeval") {
 		this->m_ga_ControlDlg.m_skipEliteReevaluation.SetCheck(valueStr == "true");
 	}
+	else if (name == "mutationRate") {
+		const double rate = std::stod(value);
+		if (rate <= 0 || rate > 1) {
+			return false;
+		}
+		this->mutationRate_ = rate;
+	}
 	// IA Optimization Dialog
 	else if (name == "ia_binNumber")
 		this->m_ia_ControlDlg.m_numBins.SetWindowTextW(valueStr);
@@ -416,6 +490,49 @@ bool MainDialog::saveUItoFile(std::string filePath) {
 	if (this->m_MultiThreadEnable.GetCheck() == BST_CHECKED) { outFile << "true" << std::endl; }
 	else { outFile << "false" << std::endl; }
 
+	outFile << "# Random Number Generator Seed (0 for random)" << std::endl;
+	outFile << "rngSeed=" << this->rngSeed_ << std::endl;
+
+	outFile << "# Stage each generation in SLM RAM and select frames per individual" << std::endl;
+	outFile << "slmFrameBank=";
+	if (this->slmFrameBank_) { outFile << "true" << std::endl; }
+	else { outFile << "false" << std::endl; }
+
+	outFile << "# Match each SLM pattern with the first camera frame exposed after it settled" << std::endl;
+	outFile << "syncAcquisition=";
+	if (this->syncAcquisition_) { outFile << "true" << std::endl; }
+	else { outFile << "false" << std::endl; }
+	outFile << "# SLM settle time in microseconds (used by syncAcquisition)" << std::endl;
+	outFile << "slmSettleTime=" << this->slmSettleTime_ << std::endl;
+
+	outFile << "# Reuse the fitness of genomes measured within fitnessCacheTTL generations at the same exposure" << std::endl;
+	outFile << "useFitnessCache=";
+	if (this->useFitnessCache_) { outFile << "true" << std::endl; }
+	else { outFile << "false" << std::endl; }
+	outFile << "fitnessCacheTTL=" << this->fitnessCacheTTL_ << std::endl;
+
+	outFile << "# Fitness function (0 mean intensity, 1 gaussian spot, 2 enhancement factor, 3 annulus contrast, 4 multiple target)" << std::endl;
+	outFile << "fitnessFunction=" << this->fitnessFunction_ << std::endl;
+	outFile << "# Target center offset from the image center (pixels) and y/x axis ratio" << std::endl;
+	outFile << "targetOffsetX=" << this->targetOffsetX_ << std::endl;
+	outFile << "targetOffsetY=" << this->targetOffsetY_ << std::endl;
+	outFile << "targetAspect=" << this->targetAspect_ << std::endl;
+	outFile << "# Multiple target spots as x,y,radius,weight separated by ; and how they are combined (0 sum, 1 min, 2 uniformity)" << std::endl;
+	outFile << "targetSpots=" << this->targetSpots_ << std::endl;
+	outFile << "targetAggregator=" << this->targetAggregator_ << std::endl;
+	outFile << "# SLM genes as rectangular bins (0) or hexagonal cells of bin size X pitch (1), within a pupil radius in pixels (0 for the whole SLM)" << std::endl;
+	outFile << "slmSegmentation=" << this->slmSegmentation_ << std::endl;
+	outFile << "slmPupilRadius=" << this->slmPupilRadius_ << std::endl;
+	outFile << "# Index map file giving the gene of each SLM pixel, used instead of slmSegmentation when set" << std::endl;
+	outFile << "slmIndexMapFile=" << this->slmIndexMapFile_ << std::endl;
+	outFile << "# Genes as coefficients of modes (0 a gene per bin, 1 Zernike, 2 Hadamard, 3 Fourier), number of modes and mode amplitude in waves" << std::endl;
+	outFile << "optimizationBasis=" << this->optimizationBasis_ << std::endl;
+	outFile << "basisModes=" << this->basisModes_ << std::endl;
+	outFile << "basisAmplitude=" << this->basisAmplitude_ << std::endl;
+	outFile << "# LUT applied in software to the SLM images (use a linear LUT on the board) and image of base phase levels added under the genome" << std::endl;
+	outFile << "softwareLUTFile=" << this->softwareLUTFile_ << std::endl;
+	outFile << "basePhaseFile=" << this->basePhaseFile_ << std::endl;
+
 	// Camera Dialog settings
 	outFile << "# Camera Settings" << std::endl;
 	this->m_cameraControlDlg.m_initialExposureTimeInput.GetWindowTextW(tempBuff);
@@ -456,6 +573,8 @@ bool MainDialog::saveUItoFile(std::string filePath) {
 	outFile << "skipEliteReeval=";
 	if (this->m_ga_ControlDlg.m_skipEliteReevaluation.GetCheck() == BST_CHECKED) { outFile << "true" << std::endl; }
 	else { outFile << "false" << std::endl; }
+	outFile << "# Chance for each gene of a new individual to mutate, in (0, 1] (SGA and steady state)" << std::endl;
+	outFile << "mutationRate=" << this->mutationRate_ << std::endl;
 	this->m_ga_ControlDlg.m_indEvalThreadCount.GetWindowTextW(tempBuff);
 	outFile << "evalIndividualsThreadCount=" << _tstof(tempBuff) << std::endl;
 	this->m_ga_ControlDlg.m_PopGenThreadCount.GetWindowTextW(tempBuff);
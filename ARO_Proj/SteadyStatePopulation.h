@@ -0,0 +1,164 @@
+////////////////////
+// SteadyStatePopulation.h - population for the steady state genetic algorithm, children are bred and inserted one at a time
+////////////////////
+
+#ifndef STEADY_STATE_POPULATION_H_
+#define STEADY_STATE_POPULATION_H_
+
+#include "Population.h"
+#include "SelectionPolicy.h"	// RouletteSelector & AliasSelector for parent selection
+
+// A child from beginChild() until it is given to insertChild() or discardChild()
+template <class T>
+struct Offspring {
+	T * genome;			// Slot of the arena the child is written into by breedChild()
+	const T * parent1;	// Parents (retained, so replacing them while the child is bred does not free their genome)
+	const T * parent2;
+	bool same_check;	// Set to false by breedChild() if the parents were not similar
+	bool randomize;		// True if the child is a random genome (diversity refresh) instead of a crossover of the parents
+};
+
+// Individuals are kept sorted by fitness so individuals_[pop_size_-1] is the best, the same place the generational populations keep it.
+// A child replaces the worst individual if it is at least as fit, so the best individuals are never lost.
+// Whether a child is a random refresh and whether it is accepted are decided by the caller (see accepts()),
+// so populations of several boards given the same decisions stay ranked alike.
+// beginChild(), insertChild() and discardChild() use the arena and must be called from the thread running the optimization,
+// breedChild() only writes the child and may run on a worker thread while another child is being measured.
+// Selector - fitness proportionate selection policy (see SelectionPolicy.h), rebuilt after every insertion
+template <class T, class Selector = RouletteSelector>
+class SteadyStatePopulation : public Population<T> {
+private:
+	// Parent selection table over the sorted individuals
+	Selector selector_;
+
+	// Rebuild the selection table after the individuals changed (they are already sorted, so rank is the identity)
+	void rebuildSelector() {
+		for (int i = 0; i < this->pop_size_; i++) {
+			this->fitness_keys_[i] = this->individuals_[i].fitness();
+			this->rank_[i] = i;
+		}
+		this->selector_.build(this->fitness_keys_, this->rank_, this->pop_size_);
+	}
+
+	// Drop the references beginChild() took to the parents of child
+	void releaseParents(const Offspring<T> & child) {
+		if (!child.randomize) {
+			this->arena_->release(child.parent1);
+			this->arena_->release(child.parent2);
+		}
+	}
+
+public:
+	// Constructor
+	// Input:
+	//	genome_length:		 the image size (genome) for an individual
+	//	population_size:	 the number of individuals for the population
+	//	elite_size:			 the number of best individuals that a random (refresh) child may not replace
+	//	accepted_similarity: precentage of similarity to be counted as same between individuals (default 90%)
+	//  seed:				 seed for the random number generator (default 0, seeds from std::random_device)
+	// Only one child is bred at a time, so a single random number stream is used and the population does not use a thread pool itself
+	SteadyStatePopulation(int genome_length, int population_size, int elite_size, double accepted_similarity = .9, unsigned long long seed = 0)
+		: Population<T>(genome_length, population_size, elite_size, accepted_similarity, false, 1, NULL, seed), selector_(population_size) {
+		this->rebuildSelector();
+	};
+
+	// Sort the individuals by fitness once every individual has been measured (start of the optimization)
+	// The steady state algorithm produces children with beginChild()/breedChild()/insertChild() instead of whole generations
+	bool nextGeneration() {
+		this->RankIndividuals(this->pop_size_);
+		// Only the views are reordered, genomes keep their slot and reference count
+		for (int r = 0; r < this->pop_size_; r++) {
+			this->next_individuals_[r] = this->individuals_[this->rank_[r]];
+		}
+		Individual<T> * temp = this->individuals_;
+		this->individuals_ = this->next_individuals_;
+		this->next_individuals_ = temp;
+
+		this->rebuildSelector();
+		return true;
+	}
+
+	// Start a new child, taking a slot for it and selecting its parents
+	// Input:
+	//	child - set up to be given to breedChild()
+	//	randomize - true for a random genome (diversity refresh) instead of a crossover of selected parents
+	// Output: false if the arena has no free slot (more children in flight than the population size)
+	bool beginChild(Offspring<T> & child, bool randomize) {
+		child.genome = this->arena_->acquire();
+		if (child.genome == NULL) {
+			Utility::printLine("ERROR: No free genome slot for a new child!");
+			return false;
+		}
+		child.same_check = true;
+		child.randomize = randomize;
+		if (child.randomize) {
+			child.parent1 = NULL;
+			child.parent2 = NULL;
+		}
+		else {
+			// select both parents with fitness proportionate selection
+			child.parent1 = this->individuals_[this->selector_.select(this->rng_machines->uniform())].genome();
+			child.parent2 = this->individuals_[this->selector_.select(this->rng_machines->uniform())].genome();
+			this->arena_->retain(child.parent1);
+			this->arena_->retain(child.parent2);
+		}
+		return true;
+	}
+
+	// Write the genome of a child started by beginChild(), crossover with mutation (or a random genome for a refresh)
+	// Uses the random number stream of the population, so only one child of a population may be bred at a time
+	// Input: child - from beginChild()
+	// Output: child.genome is written, child.same_check set to false if the parents were not similar
+	void breedChild(Offspring<T> & child) const {
+		if (child.randomize) {
+			Utility::generateRandomImage<T>(child.genome, this->genome_length_, this->rng_machines);
+		}
+		else {
+			this->Crossover(child.parent1, child.parent2, child.genome, child.same_check, true, this->rng_machines);
+		}
+	}
+
+	// True if a measured child would enter the population: it is at least as fit as the worst individual,
+	// or it is a random (refresh) child and the worst individual is not one of the elites
+	// Input: child - bred by breedChild(), fitness - measured fitness of the child
+	const bool accepts(const Offspring<T> & child, double fitness) const {
+		return (fitness >= this->individuals_[0].fitness()) || (child.randomize && this->elite_size_ < this->pop_size_);
+	}
+
+	// Insert a measured child into the population in place of the worst individual, or free its slot
+	// Input:
+	//	child - bred by breedChild(), not to be used afterwards
+	//	fitness - measured fitness of the child
+	//	accepted - decision from accepts() (of any of the populations measured with this child)
+	// Output: true if the child was inserted
+	bool insertChild(Offspring<T> & child, double fitness, bool accepted) {
+		this->releaseParents(child);
+		if (!accepted) {
+			this->arena_->release(child.genome);
+			return false;
+		}
+		this->arena_->release(this->individuals_[0].genome());
+
+		// Shift fitter individuals down into the place of the worst until the child is in sorted position
+		int pos = 0;
+		while (pos + 1 < this->pop_size_ && this->individuals_[pos + 1].fitness() <= fitness) {
+			this->individuals_[pos] = this->individuals_[pos + 1];
+			pos++;
+		}
+		this->individuals_[pos].set_genome(child.genome);
+		this->individuals_[pos].set_fitness(fitness);
+
+		this->rebuildSelector();
+		return true;
+	}
+
+	// Abandon a child (not measured, such as when the optimization stops), freeing its slot
+	// Input: child - from beginChild(), not to be used afterwards
+	void discardChild(Offspring<T> & child) {
+		this->releaseParents(child);
+		this->arena_->release(child.genome);
+	}
+
+}; // ... class SteadyStatePopulation
+
+#endif
@@ -0,0 +1,471 @@
+////////////////////
+// SteadyState_Optimization.cpp - Optimization handler methods implementation for steady state genetic algorithm
+////////////////////
+
+#include "stdafx.h"						// Required in source
+#include "SteadyState_Optimization.h"	// Header file
+
+bool SteadyState_Optimization::runOptimization() {
+	Utility::printLine("INFO: Starting " + this->algorithm_name_ + " Optimization!");
+
+	// Individuals are measured one at a time (the hardware is the bottleneck), threads are only used to breed the next child
+	this->indThreadCount = 1;
+	this->gaPoolThreadCount = 1;
+	this->myThreadPool_ = NULL;
+
+	// Setup before optimization (see base class for implementation)
+	if (!prepareSoftwareHardware()) {
+		Utility::printLine("ERROR: Failed to prepare software or/and hardware for " + this->algorithm_name_ + " Optimization");
+		return false;
+	}
+	// Setup variables that are of instance and depend on this specific optimization method (such as pop size)
+	if (!setupInstanceVariables()) {
+		Utility::printLine("ERROR: Failed to prepare values and files for " + this->algorithm_name_ + " Optimization");
+		return false;
+	}
+	if (this->multithreadEnable) {
+		// One breeding job per board
+		this->gaPoolThreadCount = (std::min)(int(std::thread::hardware_concurrency()), this->popCount);
+		this->myThreadPool_ = new threadPool(this->gaPoolThreadCount);
+		Utility::printLine("INFO: Breeding children on " + std::to_string(this->gaPoolThreadCount) + " threads while measuring");
+	}
+
+	// Start each run with an empty cache
+	this->fitnessCache.reset(this->useFitnessCache ? this->fitnessCacheTTL : 0);
+	int cacheHits, cacheMisses;
+
+	// Doubles to track time elapsed during optimization
+	double opt_start, opt_end, generation_start, generation_end, measure_start, wait_start;
+	// Per generation totals of time spent measuring children and time the hardware sat idle waiting for the next child to be bred
+	double measure_time = 0, wait_time = 0;
+	// The child being measured and the one being bred meanwhile, one per population
+	std::vector<Offspring<unsigned char>> current(this->popCount), next(this->popCount);
+	bool currentStarted = false;
+	try {	// Begin camera exception handling while optimization loop is going
+		// Lambda function to breed the child of a population on a worker thread
+		// Input: popID - population (and index into children) to breed
+		//		  children - children started by beginChildren()
+		// Captures: this - pointer to current SteadyState_Optimization instance
+		auto breedOne = [this](const int popID, std::vector<Offspring<unsigned char>> * children) {
+			this->steadyPopulation[popID]->breedChild((*children)[popID]);
+		};
+
+		this->startFrameMatching();
+
+		Utility::printLine("INFO: Beginning optimization loop");
+		this->timestamp = new TimeStampGenerator();		// Starting time stamp to track elapsed time
+		opt_start = this->timestamp->MicroS_SinceStart();
+		generation_start = opt_start;
+
+		// Measure the initial (random) population, then sort it
+		this->curr_gen = 0;
+		std::vector<const unsigned char*> genomes(this->popCount);
+		for (int indID = 0; indID < this->populationSize && !this->dlg->stopFlag; indID++) {
+			for (int popID = 0; popID < this->popCount; popID++) {
+				genomes[popID] = this->population[popID]->getGenome(indID);
+			}
+			double fitness;
+			if (!this->runChild(genomes, fitness)) {
+				break;
+			}
+			if (fitness >= 0) {
+				for (int popID = 0; popID < this->popCount; popID++) {
+					this->population[popID]->setFitness(indID, fitness);
+				}
+			}
+		}
+		for (int popID = 0; popID < this->popCount; popID++) {
+			this->steadyPopulation[popID]->nextGeneration();
+		}
+
+		// Breed the first child before the loop, from then on the next child is bred while the current one is measured
+		currentStarted = this->beginChildren(current);
+		if (currentStarted) {
+			for (int popID = 0; popID < this->popCount; popID++) {
+				this->steadyPopulation[popID]->breedChild(current[popID]);
+			}
+		}
+		this->stopConditionsMetFlag = !currentStarted;
+
+		// Number of children measured
+		long long evaluations = 0;
+		while (!this->stopConditionsMetFlag && !this->dlg->stopFlag) {
+			// Start breeding the following child
+			if (!this->beginChildren(next)) {
+				break;
+			}
+			if (this->multithreadEnable) {
+				for (int popID = 0; popID < this->popCount; popID++) {
+					this->myThreadPool_->pushJob(std::bind(breedOne, popID, &next));
+				}
+			}
+			else {
+				for (int popID = 0; popID < this->popCount; popID++) {
+					this->steadyPopulation[popID]->breedChild(next[popID]);
+				}
+			}
+
+			// Measure the current child meanwhile
+			double fitness;
+			for (int popID = 0; popID < this->popCount; popID++) {
+				genomes[popID] = current[popID].genome;
+			}
+			measure_start = this->timestamp->MicroS_SinceStart();
+			const bool measured = this->runChild(genomes, fitness);
+			wait_start = this->timestamp->MicroS_SinceStart();
+			measure_time += wait_start - measure_start;
+			if (this->multithreadEnable) {
+				this->myThreadPool_->wait();
+			}
+			wait_time += this->timestamp->MicroS_SinceStart() - wait_start;
+
+			// Insert into the ranked populations (every population gets the same fitness and decision so they stay ranked alike)
+			this->insertChildren(current, measured ? fitness : -1);
+			current.swap(next);
+			if (!measured) {
+				break;
+			}
+			evaluations++;
+
+			// Every populationSize children counts as a generation
+			if (evaluations % this->populationSize == 0) {
+				// Update displays with best individual
+				if (this->displayCamImage && this->bestImage != NULL) {
+					this->camDisplay->UpdateDisplay(this->bestImage->getRawData());
+				}
+				if (this->displaySLMImage) {
+					std::unique_lock<std::mutex> scalerLock(this->slmScalersMutex);
+					for (int slmID = 0; slmID < this->popCount; slmID++) {
+						this->scalers[slmID]->TranslateChanged(this->population[slmID]->getGenome(this->populationSize - 1), this->slmScaledImages[slmID]);
+						this->slmDisplayVector[slmID]->UpdateDisplay(this->slmScaledImages[slmID]);
+					}
+				}
+				// Save elite info
+				if ((this->saveEliteImages) && (this->curr_gen % this->saveEliteFrequency == 0) && this->bestImage != NULL) {
+					this->tfile << this->curr_gen << "," << this->population[0]->getFitness(this->populationSize - 1) << std::endl;
+					std::string curTime = Utility::getCurDateTime(); // Get current time to use as timeStamp
+					this->cc->saveImage(this->bestImage, std::string(this->outputFolder + curTime + "_" + this->algorithm_name_ + "_Gen_" + std::to_string(this->curr_gen + 1) + "_Elite_Camera" + ".bmp"));
+					std::unique_lock<std::mutex> scalerLock(this->slmScalersMutex);
+					for (int popID = 0; popID < this->popCount; popID++) {
+						this->scalers[popID]->TranslateChanged(this->population[popID]->getGenome(this->populationSize - 1), this->slmScaledImages[popID]);
+						cv::Mat m_ary = cv::Mat(this->sc->getBoardWidth(popID), this->sc->getBoardHeight(popID), CV_8UC1, this->slmScaledImages[popID]);
+						cv::imwrite(this->outputFolder + curTime + "_" + this->algorithm_name_ + "_Gen_" + std::to_string(this->curr_gen + 1) + "_Elite_SLM_" + std::to_string(this->optBoards[popID]->board_id) + ".bmp", m_ary);
+					}
+				}
+				// Output to the terminal progress to help show progress
+				if (this->curr_gen % 10 == 0) {
+					Utility::printLine("INFO: Finished generation #" + std::to_string(this->curr_gen) + " with a fitness of " + std::to_string(this->population[0]->getFitness(this->populationSize - 1)));
+				}
+				// Record the time of this generation, how long the hardware waited on breeding and how many evaluations the cache saved
+				this->fitnessCache.endGeneration(this->curr_gen, cacheHits, cacheMisses);
+				if (this->logAllFiles || this->saveTimeVSFitness) {
+					generation_end = this->timestamp->MicroS_SinceStart();
+					this->timePerGenFile << this->curr_gen + 1 << "," << measure_time << "," << wait_time << "," << generation_end - generation_start << "," << cacheHits << "," << cacheMisses << "," << this->fitnessCache.getSavedFrames() << std::endl;
+					generation_start = generation_end;
+				}
+				measure_time = 0;
+				wait_time = 0;
+				this->curr_gen++;
+			}
+
+			// Check stop conditions after every child, the initial population counts as the first generation
+			this->stopConditionsMetFlag = stopConditionsReached((this->population[0]->getFitness(this->populationSize - 1)*this->cc->GetExposureRatio()), this->timestamp->S_SinceStart(), 1 + double(evaluations) / this->populationSize);
+		} // ... optimization loop
+
+		// The child bred for the next step is never measured
+		if (currentStarted) {
+			for (int popID = 0; popID < this->popCount; popID++) {
+				this->steadyPopulation[popID]->discardChild(current[popID]);
+			}
+		}
+		this->endFrameMatching();
+
+		if (this->logAllFiles || this->saveTimeVSFitness) {
+			opt_end = this->timestamp->MicroS_SinceStart();
+			this->timePerGenFile << "\nOverall Time in Microseconds," << opt_end - opt_start << std::endl;
+			this->timePerGenFile << "Children Measured," << evaluations << std::endl;
+		}
+
+		// Cleanup & Save resulting instance
+		if (shutdownOptimizationInstance()) {
+			Utility::printLine("INFO: Successfully ended optimization instance and saved results");
+		}
+		else {
+			Utility::printLine("WARNING: Failure to properly end optimization instance!");
+		}
+	}
+	catch (std::exception &e) {
+		Utility::printLine("ERROR: " + std::string(e.what()));
+		return false;
+	}
+
+	//Reset UI State
+	// Deallocate thread pool
+	if (this->myThreadPool_ != NULL) {
+		delete this->myThreadPool_;
+	}
+
+	this->isWorking = false;
+	this->dlg->disableMainUI(!isWorking);
+	return true;
+}
+
+// Start a child in every population
+// Input: children - one per population
+// Output: false if a population could not start a child (children started before it are discarded)
+bool SteadyState_Optimization::beginChildren(std::vector<Offspring<unsigned char>> & children) {
+	const bool randomize = this->similarStreak >= (this->populationSize - this->eliteSize);
+	for (int popID = 0; popID < this->popCount; popID++) {
+		if (!this->steadyPopulation[popID]->beginChild(children[popID], randomize)) {
+			for (int i = 0; i < popID; i++) {
+				this->steadyPopulation[i]->discardChild(children[i]);
+			}
+			return false;
+		}
+	}
+	if (randomize) {
+		this->similarStreak = 0;
+	}
+	return true;
+}
+
+// Insert the children of every population as one individual
+// Input:
+//	children - one per population, measured
+//	fitness - their fitness, negative if they were not measured (discarded)
+void SteadyState_Optimization::insertChildren(std::vector<Offspring<unsigned char>> & children, double fitness) {
+	if (fitness < 0) {
+		for (int popID = 0; popID < this->popCount; popID++) {
+			this->steadyPopulation[popID]->discardChild(children[popID]);
+		}
+		return;
+	}
+	// The populations are ranked alike, so the first one decides for all
+	const bool accepted = this->steadyPopulation[0]->accepts(children[0], fitness);
+	bool similar = true;
+	for (int popID = 0; popID < this->popCount; popID++) {
+		similar = similar && children[popID].same_check;
+		this->steadyPopulation[popID]->insertChild(children[popID], fitness, accepted);
+	}
+	if (!children[0].randomize) {
+		this->similarStreak = similar ? this->similarStreak + 1 : 0;
+	}
+}
+
+// Measure one genome per board as one individual (a child or an individual of the initial population)
+// Input:
+//	genomes - one per population
+//	fitness - set to the fitness scaled by the exposure ratio, -1 if the stop flag was raised before measuring
+// Output: returns false if a critical error occurs, true otherwise
+//	bestImage replaced if the individual is the fittest measured so far (bestImageFitness)
+//	camera exposure is shortened if the image is close to saturating
+bool SteadyState_Optimization::runChild(const std::vector<const unsigned char*> & genomes, double & fitness) {
+	// Check the fitness cache before using the hardware, the key combines the genomes for every board
+	uint64_t genomeKey = 0;
+	if (this->fitnessCache.isEnabled()) {
+		for (int i = 0; i < this->popCount; i++) {
+			genomeKey = FitnessCache::hashGenome(genomes[i], this->population[i]->getGenomeLength(), genomeKey);
+		}
+		if (this->fitnessCache.lookup(genomeKey, this->cc->GetExposureRatio(), this->curr_gen, fitness)) {
+			return true;
+		}
+	}
+
+	bool stopped = false;
+	ImageController * curImage = this->measureGenomes(genomes.data(), stopped);
+	if (stopped) {
+		fitness = -1;
+		return true;
+	}
+	// Giving error and ends early if there is no data
+	if (curImage == NULL) {
+		Utility::printLine("ERROR: Image Acquisition has failed!");
+		return false;
+	}
+	// Using the image data from resulting image to determine the fitness with the selected fitness function (intensity of the target by default)
+	double targetMean;
+	std::vector<double> spotMeans(this->fitnessFunction.getSpotCount());
+	const double rawFitness = this->fitnessFunction.evaluate(curImage->getPixelData(), curImage->getPixelEncoding(), curImage->getWidth(), curImage->getHeight(), targetMean, spotMeans.data());
+	// Exposure of the frame relative to initial, needed for proper fitness value across changing exposure time
+	const double exposureTimesRatio = this->cc->GetExposureRatio(curImage->getExposureTime());
+	// Shorten the exposure for the next children if the frames are getting close to saturating
+	controlExposure(curImage, targetMean);
+	fitness = rawFitness * this->fitnessFunction.fitnessScale(exposureTimesRatio);
+
+	// Record files
+	if (this->logAllFiles || this->saveTimeVSFitness) {
+		this->timeVsFitnessFile << this->timestamp->MS_SinceStart() << "," << fitness << "," << this->cc->initialExposureTime / exposureTimesRatio << "," << exposureTimesRatio
+			<< spotColumns(spotMeans, this->fitnessFunction.fitnessScale(exposureTimesRatio), ',') << std::endl;
+	}
+	// Keep the camera image if this is the fittest individual measured so far
+	// (a running maximum, the ranked populations are not sorted while the initial population is measured)
+	if (fitness >= this->bestImageFitness) {
+		delete this->bestImage;
+		this->bestImage = curImage;
+		this->bestImageFitness = fitness;
+	}
+	else {
+		delete curImage;
+	}
+	if (this->fitnessCache.isEnabled()) {
+		this->fitnessCache.store(genomeKey, fitness, this->cc->GetExposureRatio(), this->curr_gen);
+	}
+	return true;
+}
+
+// Method to setup specific properties runOptimziation() instance
+bool SteadyState_Optimization::setupInstanceVariables() {
+	// Setting population size as well as number of elite individuals (never replaced by a random refresh child)
+	this->populationSize = 30;
+	this->eliteSize = 5;
+
+	// Get how many populations to have (same as number of boards being optimized)
+	this->popCount = int(this->optBoards.size());
+
+	// Setting population vector
+	this->population.clear();
+	this->steadyPopulation.clear();
+	this->similarStreak = 0;
+	for (int i = 0; i < this->popCount; i++) {
+		this->steadyPopulation.push_back(new SteadyStatePopulation<unsigned char>(genomeLength(i),
+			this->populationSize, this->eliteSize, this->acceptedSimilarity, this->rngSeed + i));
+		this->steadyPopulation[i]->setMutationRate(this->mutationRate);
+		this->population.push_back(this->steadyPopulation[i]);
+		if (!this->population[i]->isAllocated()) {
+			return false;
+		}
+	}
+
+	this->stopConditionsMetFlag = false;	// Set to true if a stop condition was reached
+	this->bestImage = NULL;
+	this->bestImageFitness = -1;
+	// Setup image displays for camera and SLM
+	// Open displays if preference is set
+	if (this->displayCamImage) {
+		this->camDisplay = new CameraDisplay(this->cc->cameraImageHeight, this->cc->cameraImageWidth, "Camera Display");
+		this->camDisplay->OpenDisplay(240, 240);
+	}
+	this->slmDisplayVector.clear();
+	if (this->displaySLMImage) {
+		for (int displayNum = 0; displayNum < this->popCount; displayNum++) {
+			int slmID = this->optBoards[displayNum]->board_id;
+			this->slmDisplayVector.push_back(new CameraDisplay(this->sc->getBoardHeight(slmID - 1), this->sc->getBoardWidth(slmID - 1), ("SLM Display " + std::to_string(slmID)).c_str()));
+			this->slmDisplayVector[displayNum]->OpenDisplay(240, 240);
+		}
+	}
+	// Scaler Setup (using base class)
+	this->slmScaledImages.clear();
+	// Setup the scaled images vector
+	this->slmScaledImages = std::vector<unsigned char*>(this->optBoards.size());
+	this->scalers.clear();
+	// Setup a vector of scalers for every board being optimized
+	for (int i = 0; i < this->optBoards.size(); i++) {
+		this->slmScaledImages[i] = new unsigned char[this->optBoards[i]->GetArea()];
+		this->scalers.push_back(setupScaler(this->slmScaledImages[i], i));
+	}
+
+	// Start up the camera
+	this->cc->startCamera();
+
+	//Open up files to which progress will be logged
+	if (this->logAllFiles || this->saveTimeVSFitness) {
+		this->timePerGenFile.open(this->outputFolder + this->algorithm_name_ + "_timePerformance.txt");
+		// A generation is populationSize children, the wait time is how long the hardware was idle waiting for the next child to be bred
+		this->timePerGenFile << "SSGA Generation,Measurement Time (microseconds),Breeding Wait Time (microseconds),Overall Generation Time (microseconds),Fitness Cache Hits,Fitness Cache Misses,Saved Hardware Evaluations (total)" << std::endl;
+
+		this->timeVsFitnessFile.open(this->outputFolder + this->algorithm_name_ + "_time_vs_fitness.txt");
+	}
+	if (this->logAllFiles || this->saveExposureShorten) {
+		this->efile.open(this->outputFolder + this->algorithm_name_ + "_exposure.txt");
+	}
+	if (this->logAllFiles || this->saveEliteImages) {
+		this->tfile.open(this->outputFolder + this->algorithm_name_ + "_functionEvals_vs_fitness.txt");
+	}
+
+	return true; // Returning true if no issues met
+}
+
+// Method to clean up & save resulting runOptimziation() instance
+bool SteadyState_Optimization::shutdownOptimizationInstance() {
+
+	std::string curTime = Utility::getCurDateTime();
+
+	// Only save images if not aborting (successful results)
+	if (this->dlg->stopFlag == false && (this->logAllFiles || this->saveTimeVSFitness) && this->bestImage != NULL) {
+		// Save how final optimization looks through camera
+		this->cc->saveImage(this->bestImage, this->outputFolder + curTime + "_" + this->algorithm_name_ + "_Optimized.bmp");
+
+		// Save final (most fit SLM images)
+		std::unique_lock<std::mutex> scalerLock(this->slmScalersMutex);
+		for (int popID = 0; popID < this->population.size(); popID++) {
+			// Scale the genome
+			scalers[popID]->TranslateImage(this->population[popID]->getGenome(this->population[popID]->getSize() - 1), this->slmScaledImages[popID]);
+			cv::Mat m_ary = cv::Mat(512, 512, CV_8UC1, this->slmScaledImages[popID]);
+			cv::imwrite(this->outputFolder + curTime + "_" + this->algorithm_name_ + "_phaseopt_SLM_" + std::to_string(this->optBoards[popID]->board_id) + ".bmp", m_ary);
+		}
+	}
+
+	// Generic file renaming to have time stamps of run
+	if (this->logAllFiles || this->saveTimeVSFitness) {
+		this->timeVsFitnessFile << this->timestamp->MS_SinceStart() << " " << 0 << std::endl;
+		this->timeVsFitnessFile.close();
+		this->timePerGenFile.close();
+		std::rename((this->outputFolder + this->algorithm_name_ + "_timePerformance.txt").c_str(), (this->outputFolder + curTime + "_" + this->algorithm_name_ + "_timePerformance.csv").c_str());
+		std::rename((this->outputFolder + this->algorithm_name_ + "_time_vs_fitness.txt").c_str(), (this->outputFolder + curTime + "_" + this->algorithm_name_ + "_time_vs_fitness.txt").c_str());
+	}
+	if (this->logAllFiles || this->saveEliteImages) {
+		this->tfile.close();
+		std::rename((this->outputFolder + this->algorithm_name_ + "_functionEvals_vs_fitness.txt").c_str(), (this->outputFolder + curTime + "_" + this->algorithm_name_ + "_functionEvals_vs_fitness.txt").c_str());
+	}
+	if (this->logAllFiles || this->saveExposureShorten) {
+		this->efile.close();
+		std::rename((this->outputFolder + this->algorithm_name_ + "_exposure.txt").c_str(), (this->outputFolder + curTime + "_" + this->algorithm_name_ + "_exposure.txt").c_str());
+	}
+	if (this->logAllFiles || this->saveParametersPref) {
+		saveParameters(curTime);
+		CString buff;
+		dlg->m_outputControlDlg.m_OutputLocationField.GetWindowTextW(buff);
+		std::string path = CT2A(buff);
+		path += curTime + "_" + this->algorithm_name_ + "_savedParameters.cfg";
+		dlg->saveUItoFile(path);
+	}
+
+	// - image displays
+	if (this->camDisplay != NULL) {
+		this->camDisplay->CloseDisplay();
+		delete this->camDisplay;
+	}
+	for (int i = 0; i < this->slmDisplayVector.size(); i++) {
+		this->slmDisplayVector[i]->CloseDisplay();
+		delete this->slmDisplayVector[i];
+	}
+	this->slmDisplayVector.clear();
+
+	// - camera
+	this->cc->stopCamera();
+	// - pointers
+	if (this->bestImage != NULL) {
+		delete this->bestImage;
+	}
+	// The steady state populations are the same objects as population
+	for (int i = 0; i < this->population.size(); i++) {
+		delete this->population[i];
+	}
+	this->population.clear();
+	this->steadyPopulation.clear();
+
+	if (this->timestamp != NULL) {
+		delete this->timestamp;
+	}
+	// Delete all the scalers in the vector
+	for (int i = 0; i < this->scalers.size(); i++) {
+		delete this->scalers[i];
+	}
+	this->scalers.clear();
+	// Delete all the scaled image pointers in the vector
+	for (int i = 0; i < this->slmScaledImages.size(); i++) {
+		delete[] this->slmScaledImages[i];
+	}
+	this->slmScaledImages.clear();
+	return true; // no Errors!
+}
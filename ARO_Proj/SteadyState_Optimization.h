@@ -0,0 +1,60 @@
+////////////////////
+// SteadyState_Optimization.h - handler for steady state genetic algorithm that inherits from base GA_Optimization class
+//							  - children are bred and measured one at a time, the next child is bred while the current one is on the hardware
+////////////////////
+
+#ifndef STEADY_STATE_OPTIMIZATION_H_
+#define STEADY_STATE_OPTIMIZATION_H_
+
+#include "GA_Optimization.h"
+#include "SteadyStatePopulation.h"
+
+// Uses 8 bit genes (one phase value per bin), change the GA_Optimization argument for 16 bit SLMs
+// The initial population is measured like a generation of the other GAs, afterwards there is no generation barrier:
+// one child per board is measured while the following one is bred on the thread pool, then inserted into the ranked populations.
+// Generations (for stop conditions, logging and the fitness cache) are counted as every populationSize children measured.
+class SteadyState_Optimization : public GA_Optimization<unsigned char> {
+	// The populations (also held as base pointers in population, for the shared GA code)
+	std::vector<SteadyStatePopulation<unsigned char>*> steadyPopulation;
+	// Fitness of bestImage, the highest measured so far
+	double bestImageFitness;
+	// Number of children in a row bred from similar parents on every board, when it reaches the number of non-elite individuals
+	// the next child is random (one count for all boards, so every population gets the same kind of child)
+	int similarStreak;
+
+	// Method to setup specific properties for the steady state GA
+	bool setupInstanceVariables();
+
+	// Method to clean up & save resulting steady state GA instance
+	bool shutdownOptimizationInstance();
+
+	// Start a child in every population (beginChild()), a random refresh child in all of them or in none
+	// Input: children - one per population
+	// Output: false if a population could not start a child
+	bool beginChildren(std::vector<Offspring<unsigned char>> & children);
+
+	// Insert the measured children into every population with one decision (see SteadyStatePopulation::accepts()),
+	// so index i is the same individual on every board, and update similarStreak
+	// Input: children - one per population, measured, fitness - their fitness (negative if not measured, the children are discarded)
+	void insertChildren(std::vector<Offspring<unsigned char>> & children, double fitness);
+
+	// Measure one genome per board as one individual (a child or an individual of the initial population)
+	// Input:
+	//		genomes - one per population
+	//		fitness - set to the fitness scaled by the exposure ratio, -1 if the stop flag was raised before measuring
+	// Output: returns false if a critical error occurs, true otherwise
+	//		bestImage replaced if the individual is the fittest measured so far (bestImageFitness)
+	//		camera exposure is shortened if the image is close to saturating
+	bool runChild(const std::vector<const unsigned char*> & genomes, double & fitness);
+
+public:
+	// Constructor - inherits from base class
+	SteadyState_Optimization(MainDialog* dlg, CameraController* cc, SLMController* sc) : GA_Optimization<unsigned char>(dlg, cc, sc) {
+		this->algorithm_name_ = "SSGA";
+	};
+
+	// Run the steady state genetic algorithm
+	bool runOptimization();
+};
+
+#endif
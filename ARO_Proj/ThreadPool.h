@@ -54,13 +54,13 @@ private:
 				myJob = std::move(this->job_queue.front());
 				this->job_queue.pop();
 			}
-			notify.unlock(); // Allow another thread to get into the wait
-
-			// Executing task on this thread
-			// Increment count
+			// Increment count before releasing the queue, so isBusy() never sees the job neither queued nor active
 			countLock.lock();
 			++this->num_active_tasks;
 			countLock.unlock();
+			notify.unlock(); // Allow another thread to get into the wait
+
+			// Executing task on this thread
 			myJob();
 			// Decrement count
 			countLock.lock();
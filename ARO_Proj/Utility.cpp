@@ -7,9 +7,7 @@
 
 #include <ctime>	// for getting current time for getCurDateTime and getCurLocalTime
 #include <iostream> // std::cout in printLine
-
-#include <opencv2\highgui\highgui.hpp>	//image processing used in FindAverageValue methods
-#include <opencv2\imgproc\imgproc.hpp>
+#include <algorithm> // std::remove in getCurDateTime and getCurLocalTime
 
 #include "Utility.h"
 
@@ -77,41 +75,6 @@ std::string Utility::getCurLocalTime() {
 	return finalTimeString;
 }
 
-// Calculate an average intensity from an image taken by the camera  which can be used as a fitness value
-// Input: image - pointer to the image data
-//		  width - the width of the camera image in pixels
-//		 height - the height of the camera image in pixels
-//			  r - radius of area (centered in middle of image) to find average within
-// Output: The average intensity within the calculated area
-const double Utility::FindAverageValue(const void *image, const int width, const int height, const int r) {
-	int value, ll, kk, cx, cy, ymin, ymax;
-	double rdbl, rloop, sloop, xmin, xmax, area;
-	cv::Mat m_ary = cv::Mat(int(height), int(width), CV_8UC1, (void*)image);
-	rdbl = 0;
-	rloop = 0;
-	sloop = 0;
-	cx = width / 2;
-	cy = height / 2;
-	area = 3.1416*pow(r, 2);
-	ymin = cy - r;
-	ymax = cy + r;
-
-	//calculate average
-	for (ll = ymin; ll < ymax; ll++) {
-		xmin = cx - sqrt(pow(r, 2) - pow(ll - cy, 2));
-		xmax = cx + sqrt(pow(r, 2) - pow(ll - cy, 2));
-
-		for (kk = int(xmin); kk < int(xmax); kk++){
-			value = m_ary.at<unsigned char>(ll, kk);
-			rloop += value;
-		}
-	}
-
-	rdbl = rloop / area;
-
-	return rdbl;
-}
-
 //[STRING PROCCESING]
 // Separate a string into a vector array, breaks in given character
 // Input: fullString - string to seperate into parts
@@ -8,7 +8,8 @@
 
 #include <string>	// output format of getCurDateTime and getCurLocalTime
 #include <vector>	// for seperateByDelim and rejoinClear
-#include "BetterRandom.h"
+#include "FastRandom.h"
+#include "GenomeTraits.h"	// randomGene() in generateRandomImage()
 
 // Utility namespace to encapsulate the various isolated methods that aren't associated with a particular class
 namespace Utility {
@@ -25,25 +26,20 @@ namespace Utility {
 	std::string getCurLocalTime();
 
 	// [IMAGE PROCCESSING]
-	// Calculate an average intensity from an image taken by the camera  which can be used as a fitness value
-	// Input: image - pointer to the image data
-	//		  width - the width of the camera image in pixels
-	//		 height - the height of the camera image in pixels
-	//			  r - radius of area (centered in middle of image) to find average within
-	// Output: The average intensity within the calculated area
-	const double FindAverageValue(const void *image, const int width, const int height, const int r);
-
-	// Generates a random image using BetterRandom
-	// Input: size - size of the image to make
+	// Generates a random image using FastRandom (bulk byte fill when every bit pattern is a valid gene)
+	// Input: image - the image to fill (already allocated, such as a genome slot of a GenomeArena)
+	//		  size - size of the image to make
 	//		  rng_machine - the RNG object to use for setting random pixel values
-	// Output: a randomly generated image with given size and each value being from 0 to 255
+	// Output: image is filled with randomly generated values over the phase levels of T (0 to 255 for 8 bit genes)
 	template <typename T>
-	T* generateRandomImage(int size, BetterRandom * rng_machine) {
-		int * image = new T[size];
+	void generateRandomImage(T * image, int size, FastRandom * rng_machine) {
+		if (GenomeTraits<T>::full_range) {
+			rng_machine->fill(reinterpret_cast<uint8_t*>(image), sizeof(T) * size);
+			return;
+		}
 		for (int j = 0; j < size; j++) {
-			image[j] = (T)((256 * (*rng_machine)() / RAND_MAX) - 1);
+			image[j] = randomGene<T>(rng_machine);
 		} // ... for each pixel in image
-		return image;
 	}
 
 	// [STRING PROCCESSING]
@@ -18,11 +18,13 @@ bool uGA_Optimization::setupInstanceVariables() {
 	// Setting population vector
 	this->population.clear();
 	for (int i = 0; i < this->popCount; i++) {
-		this->population.push_back(new uGAPopulation<int>(this->cc->numberOfBinsY * this->cc->numberOfBinsX * this->cc->populationDensity,
-			this->populationSize, this->eliteSize, this->acceptedSimilarity, this->multithreadEnable, this->gaPoolThreadCount, this->myThreadPool_));
+		this->population.push_back(new uGAPopulation<unsigned char>(genomeLength(i),
+			this->populationSize, this->eliteSize, this->acceptedSimilarity, this->multithreadEnable, this->gaPoolThreadCount, this->myThreadPool_, this->rngSeed + i));
+		if (!this->population[i]->isAllocated()) {
+			return false;
+		}
 	}
 
-	this->shortenExposureFlag = false; // Set to true by individual if fitness is too high, initially false
 	this->stopConditionsMetFlag = false; // Set to true if a stop condition was reached by one of the individuals, initially assumed false
 	this->bestImage = NULL;
 	// Setup image displays for camera and SLM
@@ -56,7 +58,7 @@ bool uGA_Optimization::setupInstanceVariables() {
 	//Open up files to which progress will be logged
 	if (this->logAllFiles || this->saveTimeVSFitness) {
 		this->timePerGenFile.open(this->outputFolder + this->algorithm_name_ + "_timePerformance.txt");
-		this->timePerGenFile << "uGA Generation,Individuals Time (microseconds),NextGeneration Time (microseconds),Overall Generation Time (microseconds),";
+		this->timePerGenFile << "uGA Generation,Individuals Time (microseconds),NextGeneration Time (microseconds),Overall Generation Time (microseconds),Fitness Cache Hits,Fitness Cache Misses,Saved Hardware Evaluations (total),SLM Frames,";
 		// Also for easier tracking, outputinng the thread counts as well
 		this->timePerGenFile << "Eval Individuals Threads," << this->indThreadCount << ",Next Generation Threads, " << this->gaPoolThreadCount << "\n";
 
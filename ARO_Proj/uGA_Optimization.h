@@ -9,7 +9,8 @@
 #include "GA_Optimization.h"
 #include "uGA_Population.h"
 
-class uGA_Optimization : public GA_Optimization {
+// Uses 8 bit genes (one phase value per bin), change the GA_Optimization argument for 16 bit SLMs
+class uGA_Optimization : public GA_Optimization<unsigned char> {
 	// Method to setup specific properties for uGA
 	bool setupInstanceVariables();
 
@@ -18,7 +19,7 @@ class uGA_Optimization : public GA_Optimization {
 
 public:
 	// Constructor - inherits from base class
-	uGA_Optimization(MainDialog* dlg, CameraController* cc, SLMController* sc) : GA_Optimization(dlg, cc, sc) {
+	uGA_Optimization(MainDialog* dlg, CameraController* cc, SLMController* sc) : GA_Optimization<unsigned char>(dlg, cc, sc) {
 		this->algorithm_name_ = "uGA";
 	};
 };
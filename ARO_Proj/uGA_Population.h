@@ -19,31 +19,35 @@ public:
 	//	accepted_similarity: precentage of similarity to be counted as same between individuals (default 90%)
 	//  multiThread:		 enable usage of multithreading (default true)
 	//  myThreadPool:		 set the thread pool to be used when multithreading enabled
-	uGAPopulation(int genome_length, int population_size, int elite_size, double accepted_similarity = .9, bool multiThread = true, int _threadCount = std::thread::hardware_concurrency(), threadPool * myThreadPool = NULL)
-		: Population<T>(genome_length, population_size, elite_size, accepted_similarity, multiThread, _threadCount, myThreadPool) {};
+	//  seed:				 seed for the random number generators (default 0, seeds from std::random_device)
+	uGAPopulation(int genome_length, int population_size, int elite_size, double accepted_similarity = .9, bool multiThread = true, int _threadCount = std::thread::hardware_concurrency(), threadPool * myThreadPool = NULL, unsigned long long seed = 0)
+		: Population<T>(genome_length, population_size, elite_size, accepted_similarity, multiThread, _threadCount, myThreadPool, seed) {};
 
 	// Starts next generation using fitness of individuals.
 	bool nextGeneration() {
-		// temp for storing sorted current population
-		this->SortIndividuals(this->individuals_, this->pop_size_);
+		// Rank the current population (the whole population is ordered, parents are picked by rank)
+		this->RankIndividuals(this->pop_size_);
 		Individual<T>* pool = this->individuals_;
-		// temp for storing new population before storing into this->individuals_
-		Individual<T>* temp = new Individual<T>[this->pop_size_];
+		const int * rank = this->rank_;
+		// temp for storing new population before storing into this->individuals_ (elite carried, children get fresh genomes)
+		this->prepareNextGeneration();
+		Individual<T>* temp = this->next_individuals_;
 
 		// Lambda function to do crossover and assignment in a more readibly approachable way
 		// Input: indID - index of location to store individual in temp array
-		//		parent1 - index of a parent in sorted_temp
-		//		parent2 - index of the other parent in sorted_temp
+		//		parent1 - rank of a parent in pool
+		//		parent2 - rank of the other parent in pool
 		//	    threadID - the thread running to help access appropriate RNG machine
 		// Captures:
 		//		temp - pointer array to store new individuals
-		//		pool - pointer to array of sorted individuals to draw parents from
+		//		pool - pointer to array of individuals to draw parents from
+		//		rank - ranking permutation of pool from RankIndividuals()
 		//		this - pointer to current instance of uGA_Population for accessing Crossover method with mutation disabled
-		auto genInd = [temp, pool, this](int indID, int parent1, int parent2, int threadID) {
-			temp[indID].set_genome(this->Crossover(pool[parent1].genome(), pool[parent2].genome(), this->same_check[indID], false, &this->rng_machines[threadID]));
+		auto genInd = [temp, pool, rank, this](int indID, int parent1, int parent2, int threadID) {
+			this->Crossover(pool[rank[parent1]].genome(), pool[rank[parent2]].genome(), temp[indID].genome(), this->same_check[indID], false, &this->rng_machines[threadID]);
 		};
 
-		auto genSubGroup = [temp, pool, this, &genInd](const int threadID) {
+		auto genSubGroup = [this, &genInd](const int threadID) {
 			int groupSize = this->pop_size_ / this->threadCount_;
 			int remainder = this->pop_size_ - groupSize*this->threadCount_;
 			int start_index = threadID*groupSize;
@@ -71,11 +75,8 @@ public:
 				case(3) :
 					genInd(3, 3, 2, threadID);
 					break;
-				case(4) :
-					// Keeping current best onto next generation
-					this->DeepCopyIndividual(temp[4], pool[4]);
-					break;
 				}
+				// Current best (4) was carried onto next generation by prepareNextGeneration()
 			}
 
 		}; // .. genSubGroup
@@ -93,8 +94,7 @@ public:
 			genInd(1, 4, 2, 0);
 			genInd(2, 3, 2, 0);
 			genInd(3, 3, 2, 0);
-			// Keeping current best onto next generation
-			DeepCopyIndividual(temp[4], this->individuals_[4]);
+			// Current best (4) was carried onto next generation by prepareNextGeneration()
 		}
 
 		// Collect the resulting same_check values,
@@ -129,7 +129,7 @@ public:
 					}
 				}
 				for (int id = start_index; id < start_index + groupSize && id < (this->pop_size_ - 1); id++) {
-					temp[id].set_genome(Utility::generateRandomImage<T>(this->genome_length_, &this->rng_machines[threadID]));
+					Utility::generateRandomImage<T>(temp[id].genome(), this->genome_length_, &this->rng_machines[threadID]);
 				}
 			};
 
@@ -141,14 +141,15 @@ public:
 				}
 				this->myThreadPool_->wait();
 			}
-			for (int id = 0; id < this->pop_size_ - 1; id++) {
-				temp[id].set_genome(Utility::generateRandomImage<T>(this->genome_length_, this->rng_machines));
+			else {
+				for (int id = 0; id < this->pop_size_ - 1; id++) {
+					Utility::generateRandomImage<T>(temp[id].genome(), this->genome_length_, this->rng_machines);
+				}
 			}
 		}
 
-		// Assign new population to individuals_
-		delete[] this->individuals_;
-		this->individuals_ = temp;
+		// Swap the new population into individuals_ (no genomes are deleted, the old front becomes the next back buffer)
+		this->swapGenerations();
 		return true; // No issues!
 	}	// ... Function nextGeneration
 